@@ -0,0 +1,95 @@
+#include "CaptureJob.h"
+#include "SigMF.h"
+#include <QDebug>
+#include <QSemaphore>
+#include <algorithm>
+
+namespace {
+// samples written between progress/cancel checks
+constexpr size_t kWriteBlock = size_t(1) << 18;
+} // namespace
+
+CaptureJob::CaptureJob(std::vector<std::complex<float>> &&samples,
+                       Decimator &&decimator, Resampler &&resampler,
+                       const CaptureResult &info, DiskWriter *writer,
+                       const std::atomic<unsigned> *generation)
+    : samples(std::move(samples)), decimator(std::move(decimator)),
+      resampler(std::move(resampler)), info(info), writer(writer),
+      generation(generation),
+      startGeneration(generation->load(std::memory_order_acquire)) {
+  setAutoDelete(true);
+}
+
+bool CaptureJob::cancelled() const {
+  return generation->load(std::memory_order_acquire) != startGeneration;
+}
+
+void CaptureJob::report(int percent) {
+  if (percent == lastPercent || cancelled())
+    return;
+  lastPercent = percent;
+  if (onProgress)
+    onProgress(percent);
+}
+
+void CaptureJob::run() {
+  const QString &outPath = info.filePath;
+  // Block: nothing is lost here, the job just waits for free buffers
+  const int out =
+      outPath.isEmpty() ? -1 : writer->open(outPath, DiskWriter::Block);
+  if (out < 0) {
+    qWarning() << "[RX] Capture write failed ->" << outPath;
+    return;
+  }
+  // the last few outputs are still inside the filters' delay lines; the
+  // recording ran on past the trim point by the chain's span, so only
+  // outputs that are trimmed off see the zeros pushed in here
+  std::vector<std::complex<float>> tail;
+  decimator.flush(tail);
+  resampler.process(tail.data(), tail.size(), samples);
+  resampler.flush(samples);
+
+  const size_t first = std::min(trimFront, samples.size());
+  const size_t total = std::min(trimLength, samples.size() - first);
+  report(0);
+  size_t done = 0;
+  while (done < total) {
+    if (cancelled()) {
+      writer->close(out, true);
+      qInfo() << "[RX] Capture finalize cancelled ->" << outPath;
+      return;
+    }
+    const size_t count = std::min(kWriteBlock, total - done);
+    writer->write(out, samples.data() + first + done,
+                  count * sizeof(std::complex<float>));
+    done += count;
+    report(int(done * 100 / total));
+  }
+  // wait for the I/O thread so listeners can open the file right away
+  QSemaphore closed;
+  bool ok = false;
+  writer->close(out, false, [&closed, &ok](bool written) {
+    ok = written;
+    closed.release();
+  });
+  closed.acquire();
+  if (!ok) {
+    qWarning() << "[RX] Capture write failed ->" << outPath;
+    return;
+  }
+  report(100);
+  qInfo() << "[RX] Capture COMPLETE ->" << outPath << "samples(out)=" << total
+          << "D=" << decimator.factor() << "L/M=" << resampler.up() << "/"
+          << resampler.down() << "outRate=" << info.sampleRate;
+  // release the capture memory before telling anyone we are done
+  std::vector<std::complex<float>>().swap(samples);
+  info.samples = total;
+  // on top of any rate change the samples had before the job's chain
+  info.decimation *= decimator.factor();
+  info.resampleUp *= resampler.up();
+  info.resampleDown *= resampler.down();
+  if (sigmf::writeMeta(info))
+    info.metaPath = sigmf::metaPathFor(outPath);
+  if (onFinished)
+    onFinished(info);
+}
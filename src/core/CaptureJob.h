@@ -0,0 +1,55 @@
+#pragma once
+#include "CaptureResult.h"
+#include "Decimator.h"
+#include "DiskWriter.h"
+#include "Resampler.h"
+#include <QRunnable>
+#include <atomic>
+#include <complex>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Finalizes one triggered capture off the RX thread. The capture was
+// band-limited and resampled while it was recorded; the job takes the
+// output samples and the filter chain that produced them, flushes the tail
+// still held in the filters and writes CF32 through the DiskWriter, so the
+// RX loop hands everything over and goes straight back to streaming.
+class CaptureJob : public QRunnable {
+public:
+  // info carries the file path, centre, output rate and trigger edges; the
+  // job fills in the sample count and filter factors and writes the SigMF
+  // sidecar next to the file. writer must outlive the job. It gives up as
+  // soon as *generation no longer matches the value it had at construction;
+  // bump it to cancel every job still queued or running.
+  CaptureJob(std::vector<std::complex<float>> &&samples, Decimator &&decimator,
+             Resampler &&resampler, const CaptureResult &info,
+             DiskWriter *writer, const std::atomic<unsigned> *generation);
+
+  // Called on the pool thread. onProgress gets 0..100 and only fires when
+  // the value changes; onFinished runs once the file is fully on disk and
+  // is skipped when the job was cancelled.
+  std::function<void(int percent)> onProgress;
+  std::function<void(const CaptureResult &result)> onFinished;
+  // Output samples to drop from the front and to keep after that, once
+  // the filters are flushed; lands the file exactly on the trigger window.
+  // The samples must run on past the last kept output by the chain's delay
+  // (plus one decimated sample), so the flush never reaches the file.
+  size_t trimFront{0};
+  size_t trimLength{SIZE_MAX};
+
+  void run() override;
+
+private:
+  bool cancelled() const;
+  void report(int percent);
+
+  std::vector<std::complex<float>> samples;
+  Decimator decimator;
+  Resampler resampler;
+  CaptureResult info;
+  DiskWriter *writer;
+  const std::atomic<unsigned> *generation;
+  unsigned startGeneration;
+  int lastPercent{-1};
+};
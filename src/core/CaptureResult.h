@@ -0,0 +1,43 @@
+#pragma once
+#include "StreamStats.h"
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+// What a finished capture produced: a file of IQ samples at an exact
+// sample rate, centred on centerHz, and everything its SigMF sidecar
+// records about how it was taken.
+struct CaptureResult {
+  QString filePath;
+  QString metaPath; // SigMF sidecar, empty if it could not be written
+  // SigMF datatype of the file: "cf32_le" for triggered captures, "ci8"
+  // for the raw stream
+  QString datatype{"cf32_le"};
+  double centerHz{0.0};
+  double sampleRate{0.0};
+  quint64 samples{0};
+  // receiver settings behind it
+  QString device; // label (and serial) of the SDR it came from
+  double gainDb{0.0};
+  double inputRate{0.0}; // stream rate before decimation / resampling
+  int decimation{1};
+  int resampleUp{1};
+  int resampleDown{1};
+  // Trigger edges as stream sample indices and UTC times (ns since the
+  // epoch). The file spans preSeconds before the rising edge to
+  // postSeconds after the falling one; startTimeNs is its first sample.
+  quint64 triggerSample{0};
+  quint64 releaseSample{0};
+  qint64 triggerTimeNs{0};
+  qint64 releaseTimeNs{0};
+  qint64 startTimeNs{0};
+  // the same edges as sample offsets into the file, and the stream index
+  // file sample 0 is centred on
+  quint64 triggerOffset{0};
+  quint64 releaseOffset{0};
+  double startSample{0.0};
+  qint64 armTimeNs{0}; // when the trigger was armed, 0 for none
+  // zero-filled stretches inside the file, as file sample offsets
+  QVector<StreamGap> gaps;
+};
+Q_DECLARE_METATYPE(CaptureResult)
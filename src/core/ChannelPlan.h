@@ -0,0 +1,23 @@
+#pragma once
+#include <QMetaType>
+#include <QVector>
+
+// One watched channel of a ChannelPlan and its trigger settings.
+struct ChannelWatch {
+  int channel{0};            // 0 .. channels - 1
+  double thresholdDb{-30.0}; // mean channel power, 0 dB = full scale
+  double dwellSeconds{0.02};
+  double preSeconds{0.2};
+  double postSeconds{0.2};
+};
+
+// Splits the RX band into `channels` equal channels, rate / channels wide;
+// channel k is centred on RX + k * rate / channels, the upper half wrapping
+// round to negative offsets. Every watched channel triggers on its own and
+// writes its own captures at the channel rate. channels < 2 or no watches
+// turns the channelizer off.
+struct ChannelPlan {
+  int channels{0};
+  QVector<ChannelWatch> watches;
+};
+Q_DECLARE_METATYPE(ChannelPlan)
@@ -0,0 +1,67 @@
+#include "ChannelPowerDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// input samples converted and filtered per pass
+constexpr size_t kBlock = 8192;
+constexpr double kMinPower = 1e-12; // -120 dBFS
+} // namespace
+
+void ChannelPowerDetector::configure(double rate, double offsetHz,
+                                     double spanHalfHz,
+                                     double windowSeconds) {
+  inRate = rate;
+  decimator.configure(rate, spanHalfHz);
+  windowLen = std::max(
+      1, int(std::lround(windowSeconds * decimator.outputRate())));
+  mixing = offsetHz != 0.0 && rate > 0.0;
+  const double w = -2.0 * M_PI * offsetHz / std::max(rate, 1.0);
+  step = {std::cos(w), std::sin(w)};
+  reset();
+}
+
+void ChannelPowerDetector::reset(uint64_t firstIndex) {
+  decimator.reset();
+  // output k of the decimator is centred on input delay() + k * D and
+  // stands for the D inputs around it
+  const double lead =
+      decimator.delay() - 0.5 * double(decimator.factor() - 1);
+  nextFirst = firstIndex + uint64_t(std::max(0ll, std::llround(lead)));
+  phasor = {1.0, 0.0};
+  accPower = 0.0;
+  accCount = 0;
+}
+
+void ChannelPowerDetector::process(const dsp::Cs8 *in, size_t n, float scale,
+                                   std::vector<Reading> &out) {
+  converted.resize(kBlock);
+  const uint32_t perReading = uint32_t(windowSamples());
+  while (n > 0) {
+    const size_t count = std::min(n, kBlock);
+    dsp::cs8ToComplex(in, scale, converted.data(), int(count));
+    if (mixing) {
+      for (size_t i = 0; i < count; ++i) {
+        converted[i] *= std::complex<float>(phasor);
+        phasor *= step;
+      }
+      // keep the phasor on the unit circle
+      phasor /= std::abs(phasor);
+    }
+    reduced.clear();
+    decimator.process(converted.data(), count, reduced);
+    for (const std::complex<float> &z : reduced) {
+      accPower += double(std::norm(z));
+      if (++accCount < windowLen)
+        continue;
+      const double mean = accPower / double(windowLen);
+      out.push_back({float(10.0 * std::log10(std::max(mean, kMinPower))),
+                     perReading, nextFirst});
+      nextFirst += perReading;
+      accPower = 0.0;
+      accCount = 0;
+    }
+    in += count;
+    n -= count;
+  }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "Decimator.h"
+#include "DspKernels.h"
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+// Time-domain trigger detector for one channel. The input is mixed so the
+// channel sits at DC, band-limited and decimated to the channel span, and
+// its mean power is read out over short sub-windows (tens of microseconds
+// by default). Decisions therefore resolve far below one FFT frame and do
+// not depend on the display FFT size or its smoothing.
+class ChannelPowerDetector {
+public:
+  struct Reading {
+    float levelDb;    // 10*log10(mean |x|^2), 0 dB = full scale
+    uint32_t samples; // input samples this reading covers
+    uint64_t first;   // stream index of the first of them
+  };
+  static constexpr double kDefaultWindowSeconds = 20e-6;
+
+  // Builds the filter for a channel offsetHz from the RX centre and
+  // spanHalfHz wide on each side, and clears all state.
+  void configure(double rate, double offsetHz, double spanHalfHz,
+                 double windowSeconds = kDefaultWindowSeconds);
+  // Clears all state; the next sample fed is stream sample firstIndex.
+  void reset(uint64_t firstIndex = 0);
+  bool configured() const { return inRate > 0.0; }
+
+  // Feeds n raw samples (scaled by `scale` to full scale 1) and appends one
+  // reading per completed sub-window. Readings come out the filter's group
+  // delay after the samples they describe; `first` already accounts for
+  // it.
+  void process(const dsp::Cs8 *in, size_t n, float scale,
+               std::vector<Reading> &out);
+
+  // Input samples per reading.
+  int windowSamples() const { return windowLen * decimator.factor(); }
+  double resolutionSeconds() const {
+    return inRate > 0.0 ? double(windowSamples()) / inRate : 0.0;
+  }
+
+private:
+  Decimator decimator;
+  double inRate{0.0};
+  int windowLen{1}; // decimated samples per reading
+  // mixer: a unit phasor advanced by `step` per input sample
+  bool mixing{false};
+  std::complex<double> phasor{1.0, 0.0};
+  std::complex<double> step{1.0, 0.0};
+  std::vector<std::complex<float>> converted;
+  std::vector<std::complex<float>> reduced;
+  double accPower{0.0};
+  int accCount{0};
+  uint64_t nextFirst{0}; // `first` of the reading being accumulated
+};
@@ -0,0 +1,70 @@
+#include "Channelizer.h"
+#include "Decimator.h"
+#include "FftPlanCache.h"
+#include <algorithm>
+#include <cstring>
+
+Channelizer::~Channelizer() { release(); }
+
+void Channelizer::release() {
+  if (branch)
+    fftwf_free(branch);
+  if (bins)
+    fftwf_free(bins);
+  branch = bins = nullptr;
+  plan = nullptr;
+}
+
+void Channelizer::configure(int channels, int tapsPerBranch) {
+  release();
+  M = std::max(2, channels);
+  P = std::max(2, tapsPerBranch);
+  // each channel passes +-fs/(2M); the transition straddles the edge
+  taps = Decimator::designLowpass(0.5 / double(M), 1.0, M * P);
+  branch = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * size_t(M));
+  bins = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * size_t(M));
+  plan = FftPlanCache::instance().acquire(M, FFTW_BACKWARD);
+  reset();
+}
+
+void Channelizer::reset() {
+  buf.clear();
+  // windows end on multiples of M, which keeps every channel's
+  // demodulating phase at zero; the first one ends on input M * P
+  pos = 1;
+}
+
+void Channelizer::process(const std::complex<float> *in, size_t n,
+                          std::vector<std::vector<std::complex<float>>> &out) {
+  out.resize(size_t(M));
+  if (!plan)
+    return;
+  buf.insert(buf.end(), in, in + n);
+  const size_t span = size_t(M) * size_t(P);
+  const float *h = taps.data();
+  size_t p = pos;
+  for (; p + span <= buf.size(); p += size_t(M)) {
+    // v[m] = sum_j h[m + jM] x[e - m - jM] with e the window's last input;
+    // channel k is then the (unnormalised) inverse DFT of v at k
+    const std::complex<float> *x = buf.data() + p + span - 1;
+    for (int m = 0; m < M; ++m) {
+      std::complex<float> acc = 0.0f;
+      for (int j = 0; j < P; ++j) {
+        const int r = m + j * M;
+        acc += h[r] * x[-r];
+      }
+      branch[m][0] = acc.real();
+      branch[m][1] = acc.imag();
+    }
+    fftwf_execute_dft(plan->get(), branch, bins);
+    for (int k = 0; k < M; ++k)
+      out[size_t(k)].emplace_back(bins[k][0], bins[k][1]);
+  }
+  const size_t dropped = std::min(p, buf.size());
+  const size_t keep = buf.size() - dropped;
+  if (keep > 0 && dropped > 0)
+    std::memmove(buf.data(), buf.data() + dropped,
+                 keep * sizeof(std::complex<float>));
+  buf.resize(keep);
+  pos = p - dropped;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <complex>
+#include <fftw3.h>
+#include <vector>
+
+class FftPlan;
+
+// Critically sampled polyphase analysis filter bank. Splits a complex
+// stream at rate fs into M channels, each fs/M wide and decimated by M:
+// channel k is centred on k * fs / M (k >= M/2 are the negative
+// frequencies). Every M inputs cost one M-branch polyphase pass (P taps
+// per branch) and one M-point FFT, however many channels are watched.
+// Neighbouring channels overlap at their edges, as a critically sampled
+// bank does.
+class Channelizer {
+public:
+  Channelizer() = default;
+  ~Channelizer();
+  Channelizer(const Channelizer &) = delete;
+  Channelizer &operator=(const Channelizer &) = delete;
+
+  // M >= 2 channels with tapsPerBranch taps in each polyphase branch.
+  // Clears all history.
+  void configure(int channels, int tapsPerBranch = 16);
+  void reset();
+
+  int channels() const { return M; }
+  // Output n of every channel is centred on input sample delay() + n * M.
+  double delay() const { return 0.5 * double(M * P + 1); }
+  // Offset of channel k from the input's centre, as a fraction of fs.
+  double channelOffset(int k) const {
+    return double(k < (M + 1) / 2 ? k : k - M) / double(M);
+  }
+
+  // Filters n input samples and appends each channel's new outputs to
+  // out[k]; out is resized to channels().
+  void process(const std::complex<float> *in, size_t n,
+               std::vector<std::vector<std::complex<float>>> &out);
+
+private:
+  void release();
+
+  int M{0};
+  int P{0};
+  std::vector<float> taps; // prototype low-pass, M * P taps
+  std::vector<std::complex<float>> buf; // unconsumed input, oldest first
+  size_t pos{0};                        // start of the next output window
+  const FftPlan *plan{nullptr};
+  fftwf_complex *branch{nullptr}; // polyphase outputs, FFT input
+  fftwf_complex *bins{nullptr};   // FFT output: one sample per channel
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free single-producer/single-consumer queue of movable values.
+// Used to hand control commands to a busy worker loop without going through
+// an event loop: the producer push()es, the consumer drains with pop() at a
+// point of its choosing. Capacity is fixed; push() fails when full.
+template <typename T, size_t N> class CommandQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0,
+                "CommandQueue capacity must be a power of two");
+
+public:
+  // Producer side
+  bool push(T &&value) {
+    const size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == N)
+      return false;
+    items[h & (N - 1)] = std::move(value);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool pop(T &out) {
+    const size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+      return false;
+    out = std::move(items[t & (N - 1)]);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+  bool empty() const {
+    return tail.load(std::memory_order_relaxed) ==
+           head.load(std::memory_order_acquire);
+  }
+
+private:
+  T items[N];
+  alignas(64) std::atomic<size_t> head{0}; // next slot to write
+  alignas(64) std::atomic<size_t> tail{0}; // next slot to read
+};
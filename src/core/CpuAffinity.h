@@ -0,0 +1,35 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Restricts the calling thread to `cores`; threads it starts afterwards
+// inherit the set. Does nothing for an empty set or off Linux. False if
+// the OS refused.
+inline bool pinCurrentThread(const std::vector<int> &cores) {
+#ifdef __linux__
+  if (cores.empty())
+    return true;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int c : cores)
+    CPU_SET(c, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  (void)cores;
+  return true;
+#endif
+}
+
+// Every CPU, for handing a pinned thread the whole machine back.
+inline std::vector<int> allCores() {
+  std::vector<int> cores;
+  const unsigned n = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < n; ++i)
+    cores.push_back(int(i));
+  return cores;
+}
@@ -0,0 +1,188 @@
+#include "Decimator.h"
+#include "DspKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// A Blackman-windowed sinc of N taps falls from the passband to about
+// -74 dB over 5.5 / N of its sample rate.
+constexpr double kBlackmanTransition = 5.5;
+// outRate / spanHalfHz that factorFor() keeps: 2 for complex Nyquist plus
+// a transition band of a fifth of the output rate for the final stage
+constexpr double kOutputPerSpan = 2.5;
+// the final FIR stage's length is sized from its transition band, within
+constexpr int kMinFinalTaps = 31;
+constexpr int kMaxFinalTaps = 4095;
+// Half-band lengths are 4K+3 so the outermost taps are non-zero.
+constexpr int kMinHalfbandTaps = 7;
+constexpr int kMaxHalfbandTaps = 127;
+
+// Half-band (cutoff fs/4) sized for the band that must survive, as a
+// fraction of the stage input rate. Early stages in a long cascade only
+// have to keep a narrow band alias-free, so they get very short filters.
+std::vector<float> designHalfband(double passFraction) {
+  const double transition = std::max(0.5 - 2.0 * passFraction, 1e-3);
+  int n = int(std::ceil(kBlackmanTransition / transition)) + 1;
+  n = std::clamp(n, kMinHalfbandTaps, kMaxHalfbandTaps);
+  n = (n / 4) * 4 + 3; // round up to 4K+3
+  n = std::min(n, kMaxHalfbandTaps);
+  std::vector<float> h = Decimator::designLowpass(0.25, 1.0, n);
+  // force the exact zeros so the fast path can skip them
+  const int mid = (n - 1) / 2;
+  for (int i = 0; i < n; ++i)
+    if (i != mid && ((i - mid) % 2) == 0)
+      h[size_t(i)] = 0.0f;
+  return h;
+}
+} // namespace
+
+std::vector<float> Decimator::designLowpass(double cutoffHz, double fs,
+                                            int taps) {
+  std::vector<float> h;
+  h.resize(std::max(3, taps));
+  int M = int(h.size());
+  double fc = std::clamp(cutoffHz / fs, 1e-6, 0.49); // 0..0.5
+  // centred on (M - 1) / 2, half-way between two taps for even M, so
+  // every length is symmetric and delays (M - 1) / 2 samples
+  const double mid = 0.5 * double(M - 1);
+  double sum = 0.0;
+  for (int n = 0; n < M; ++n) {
+    double m = double(n) - mid;
+    double wnd = 0.42 - 0.5 * std::cos(2.0 * M_PI * n / (M - 1)) +
+                 0.08 * std::cos(4.0 * M_PI * n / (M - 1));
+    // ideal low-pass impulse response: 2 fc sinc(2 fc m)
+    double ideal;
+    if (std::abs(m) < 1e-12)
+      ideal = 2.0 * fc;
+    else
+      ideal = std::sin(2.0 * M_PI * fc * m) / (M_PI * m);
+    double val = ideal * wnd;
+    h[n] = float(val);
+    sum += val;
+  }
+  if (sum != 0.0) {
+    for (auto &v : h)
+      v = float(double(v) / sum);
+  }
+  return h;
+}
+
+int Decimator::factorFor(double rate, double spanHalfHz) {
+  if (rate <= 0.0)
+    return 1;
+  return std::max(1, int(std::floor(
+                         rate / (kOutputPerSpan * std::max(1.0, spanHalfHz)))));
+}
+
+void Decimator::configure(double rate, double spanHalfHz, int factor) {
+  const double spanHalf = std::max(1.0, spanHalfHz);
+  total = factor > 0 ? factor : factorFor(rate, spanHalf);
+  outRate = rate / double(total);
+  int odd = total;
+  int twos = 0;
+  while ((odd % 2) == 0) {
+    odd /= 2;
+    ++twos;
+  }
+
+  stages.clear();
+  double fs = rate;
+  size_t inputPerSample = 1; // stage-input samples per original sample
+  flushLength = 0;
+  centre = 0.0;
+  for (int i = 0; i < twos; ++i) {
+    Stage s;
+    s.taps = designHalfband(spanHalf / fs);
+    s.decim = 2;
+    s.halfband = true;
+    flushLength += (s.taps.size() / 2) * inputPerSample;
+    centre += 0.5 * double(s.taps.size() - 1) * double(inputPerSample);
+    inputPerSample *= 2;
+    stages.push_back(std::move(s));
+    fs /= 2.0;
+  }
+  // The final stage keeps the span flat to its edge and must be down at
+  // outRate - spanHalf, the first frequency its decimation folds back
+  // into the span (without decimation: at the output Nyquist). The
+  // cutoff sits mid-way and the length follows from the width between.
+  Stage last;
+  const double stop = odd > 1 ? outRate - spanHalf : 0.5 * outRate;
+  const double width = std::max(stop - spanHalf, 0.02 * outRate);
+  int taps = int(std::ceil(kBlackmanTransition * fs / width)) + 1;
+  taps = std::clamp(taps | 1, kMinFinalTaps, kMaxFinalTaps);
+  last.taps = designLowpass(spanHalf + 0.5 * width, fs, taps);
+  last.dup.resize(last.taps.size() * 2);
+  for (size_t k = 0; k < last.taps.size(); ++k)
+    last.dup[2 * k] = last.dup[2 * k + 1] = last.taps[k];
+  last.decim = odd;
+  flushLength += (last.taps.size() / 2) * inputPerSample;
+  centre += 0.5 * double(last.taps.size() - 1) * double(inputPerSample);
+  stages.push_back(std::move(last));
+  reset();
+}
+
+void Decimator::reset() {
+  for (Stage &s : stages) {
+    s.buf.clear();
+    s.pos = 0;
+  }
+}
+
+void Decimator::run(Stage &s, const std::complex<float> *in, size_t n,
+                    std::vector<std::complex<float>> &out) {
+  s.buf.insert(s.buf.end(), in, in + n);
+  const size_t M = s.taps.size();
+  const float *h = s.taps.data();
+  const std::complex<float> *x = s.buf.data();
+  size_t p = s.pos;
+  if (s.halfband) {
+    // y = c * x[mid] + sum over odd offsets j of h[mid-j] (x[mid-j]+x[mid+j])
+    const size_t mid = (M - 1) / 2;
+    const float c = h[mid];
+    for (; p + M <= s.buf.size(); p += 2) {
+      const std::complex<float> *w = x + p;
+      std::complex<float> acc = c * w[mid];
+      for (size_t j = 1; j <= mid; j += 2)
+        acc += h[mid - j] * (w[mid - j] + w[mid + j]);
+      out.push_back(acc);
+    }
+  } else {
+    // taps are symmetric, so the window can be walked forward
+    const size_t step = size_t(s.decim);
+    for (; p + M <= s.buf.size(); p += step)
+      out.push_back(dsp::firDot(x + p, s.dup.data(), int(M)));
+  }
+  // keep only what the next window still needs; with decim > M the next
+  // window can start beyond the data we have, which pos then carries
+  const size_t dropped = std::min(p, s.buf.size());
+  const size_t keep = s.buf.size() - dropped;
+  if (keep > 0 && dropped > 0)
+    std::memmove(s.buf.data(), s.buf.data() + dropped,
+                 keep * sizeof(std::complex<float>));
+  s.buf.resize(keep);
+  s.pos = p - dropped;
+}
+
+void Decimator::process(const std::complex<float> *in, size_t n,
+                        std::vector<std::complex<float>> &out) {
+  if (stages.empty()) {
+    out.insert(out.end(), in, in + n);
+    return;
+  }
+  const std::complex<float> *src = in;
+  size_t len = n;
+  for (size_t i = 0; i + 1 < stages.size(); ++i) {
+    std::vector<std::complex<float>> &dst = scratch[i & 1];
+    dst.clear();
+    run(stages[i], src, len, dst);
+    src = dst.data();
+    len = dst.size();
+  }
+  run(stages.back(), src, len, out);
+}
+
+void Decimator::flush(std::vector<std::complex<float>> &out) {
+  const std::vector<std::complex<float>> zeros(flushLength);
+  process(zeros.data(), zeros.size(), out);
+}
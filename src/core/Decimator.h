@@ -0,0 +1,60 @@
+#pragma once
+#include <complex>
+#include <vector>
+
+// Streaming complex decimator that band-limits to +/- spanHalfHz around DC.
+// The overall factor D = 2^k * R is split into k half-band stages followed
+// by one FIR stage that sets the final cutoff and decimates by R. Every
+// stage only evaluates the outputs it keeps (the polyphase form), and
+// half-bands also skip their zero taps and fold the symmetric ones, so the
+// cost per input sample falls with each stage. State carries across
+// process() calls; blocks of any size can be fed as they arrive.
+class Decimator {
+public:
+  // Largest factor that keeps outRate >= 2.5 * spanHalfHz: complex
+  // Nyquist plus room for the final stage's transition band, so the span
+  // is flat to its edge and nothing folds back into it.
+  static int factorFor(double rate, double spanHalfHz);
+  // Blackman-windowed sinc low-pass with unity DC gain, symmetric about
+  // (taps - 1) / 2 for odd and even lengths alike.
+  static std::vector<float> designLowpass(double cutoffHz, double fs,
+                                          int taps);
+
+  // Builds the cascade for `rate` and clears all history. factor 0 picks
+  // factorFor(rate, spanHalfHz); a smaller one leaves headroom for a
+  // following resampler. The passband is the span either way.
+  void configure(double rate, double spanHalfHz, int factor = 0);
+  void reset();
+
+  int factor() const { return total; }
+  int halfbandStages() const { return int(stages.size()) - 1; }
+  double outputRate() const { return outRate; }
+  // Output k is centred on input sample delay() + k * factor().
+  double delay() const { return centre; }
+
+  // Filters n input samples and appends the resulting outputs to out.
+  void process(const std::complex<float> *in, size_t n,
+               std::vector<std::complex<float>> &out);
+  // Pushes zeros through the filters so the outputs still held back by
+  // their delay line come out too. Call once at the end of a stream.
+  void flush(std::vector<std::complex<float>> &out);
+
+private:
+  struct Stage {
+    std::vector<float> taps; // full response, symmetric
+    std::vector<float> dup;  // taps doubled for dsp::firDot (FIR stage)
+    int decim{1};
+    bool halfband{false};
+    std::vector<std::complex<float>> buf; // unconsumed input, oldest first
+    size_t pos{0}; // start of the next output window in buf
+  };
+  static void run(Stage &s, const std::complex<float> *in, size_t n,
+                  std::vector<std::complex<float>> &out);
+
+  std::vector<Stage> stages;
+  std::vector<std::complex<float>> scratch[2]; // inter-stage blocks
+  int total{1};
+  double outRate{0.0};
+  size_t flushLength{0}; // input samples that clear the whole delay
+  double centre{0.0};    // see delay()
+};
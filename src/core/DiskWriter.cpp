@@ -0,0 +1,338 @@
+#include "DiskWriter.h"
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef DUALITY_HAVE_IO_URING
+#include <cerrno>
+#include <liburing.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr size_t kAlignment = 4096;
+#ifdef DUALITY_HAVE_IO_URING
+constexpr unsigned kRingDepth = 32;
+#endif
+} // namespace
+
+#ifdef DUALITY_HAVE_IO_URING
+struct DiskWriter::Uring {
+  io_uring ring;
+};
+#else
+struct DiskWriter::Uring {};
+#endif
+
+DiskWriter::DiskWriter(size_t bufferBytes, int maxBuffers)
+    : bufferBytes(
+          std::max(kAlignment, bufferBytes / kAlignment * kAlignment)),
+      maxBuffers(std::max(2, maxBuffers)) {
+#ifdef DUALITY_HAVE_IO_URING
+  uring = std::make_unique<Uring>();
+  if (io_uring_queue_init(kRingDepth, &uring->ring, 0) < 0) {
+    qWarning() << "[IO] io_uring unavailable, using blocking writes";
+    uring.reset();
+  }
+#endif
+  thread = QThread::create([this]() { run(); });
+  thread->setObjectName("DiskWriter");
+  thread->start();
+  qInfo() << "[IO] Disk writer up, buffers=" << this->maxBuffers << "x"
+          << this->bufferBytes << "bytes" << (uring ? "(io_uring)" : "");
+}
+
+DiskWriter::~DiskWriter() {
+  // flush what producers still hold, then let the I/O thread drain
+  std::vector<int> open;
+  {
+    QMutexLocker lock(&mutex);
+    for (auto &f : files)
+      open.push_back(f.first);
+  }
+  for (int h : open)
+    close(h);
+  {
+    QMutexLocker lock(&mutex);
+    stopping = true;
+    workReady.wakeAll();
+  }
+  thread->wait();
+  delete thread;
+#ifdef DUALITY_HAVE_IO_URING
+  if (uring)
+    io_uring_queue_exit(&uring->ring);
+#endif
+  for (auto &b : buffers)
+    std::free(b->data);
+}
+
+int DiskWriter::open(const QString &path, Policy policy) {
+  auto f = std::make_unique<File>();
+  f->file = std::make_unique<QFile>(path);
+  if (!f->file->open(QIODevice::WriteOnly | QIODevice::Truncate |
+                     QIODevice::Unbuffered)) {
+    qWarning() << "[IO] Cannot open" << path;
+    return -1;
+  }
+  f->policy = policy;
+  QMutexLocker lock(&mutex);
+  const int handle = nextHandle++;
+  files.emplace(handle, std::move(f));
+  return handle;
+}
+
+DiskWriter::File *DiskWriter::lookup(int handle) {
+  QMutexLocker lock(&mutex);
+  auto it = files.find(handle);
+  return it == files.end() ? nullptr : it->second.get();
+}
+
+DiskWriter::Buffer *DiskWriter::acquire(Policy policy) {
+  QMutexLocker lock(&mutex);
+  for (;;) {
+    if (!freeBuffers.empty()) {
+      Buffer *b = freeBuffers.back();
+      freeBuffers.pop_back();
+      b->used = 0;
+      return b;
+    }
+    if (int(buffers.size()) < maxBuffers) {
+      auto b = std::make_unique<Buffer>();
+      b->data =
+          static_cast<char *>(std::aligned_alloc(kAlignment, bufferBytes));
+      if (!b->data)
+        return nullptr;
+      buffers.push_back(std::move(b));
+      return buffers.back().get();
+    }
+    if (policy == Drop)
+      return nullptr;
+    bufferFree.wait(&mutex);
+  }
+}
+
+void DiskWriter::enqueue(Op op) {
+  QMutexLocker lock(&mutex);
+  if (op.buf) {
+    ++counters.buffersInFlight;
+    counters.peakBuffersInFlight =
+        std::max(counters.peakBuffersInFlight, counters.buffersInFlight);
+  }
+  queue.push_back(std::move(op));
+  workReady.wakeOne();
+}
+
+bool DiskWriter::write(int handle, const void *data, size_t bytes) {
+  File *f = lookup(handle);
+  if (!f)
+    return false;
+  const char *src = static_cast<const char *>(data);
+  while (bytes > 0) {
+    if (!f->current) {
+      f->current = acquire(f->policy);
+      if (!f->current) {
+        // skip the dropped bytes rather than splice the file: the hole
+        // reads back as zeros, so offsets still follow the stream
+        f->queuedBytes += bytes;
+        QMutexLocker lock(&mutex);
+        counters.bytesDropped += bytes;
+        f->dropped = true;
+        return false;
+      }
+    }
+    Buffer *b = f->current;
+    const size_t n = std::min(bytes, bufferBytes - b->used);
+    std::memcpy(b->data + b->used, src, n);
+    b->used += n;
+    src += n;
+    bytes -= n;
+    if (b->used == bufferBytes) {
+      Op op;
+      op.file = f;
+      op.buf = b;
+      op.offset = f->queuedBytes;
+      f->queuedBytes += b->used;
+      f->current = nullptr;
+      enqueue(std::move(op));
+    }
+  }
+  return true;
+}
+
+void DiskWriter::close(int handle, bool remove,
+                       std::function<void(bool ok)> onClosed) {
+  File *f = nullptr;
+  {
+    // detach the handle; ownership moves to the close op and the I/O
+    // thread deletes the file once it is done with it
+    QMutexLocker lock(&mutex);
+    auto it = files.find(handle);
+    if (it != files.end()) {
+      f = it->second.release();
+      files.erase(it);
+    }
+  }
+  if (!f) {
+    if (onClosed)
+      onClosed(false);
+    return;
+  }
+  Op op;
+  op.file = f;
+  op.close = true;
+  op.remove = remove;
+  op.onClosed = std::move(onClosed);
+  if (f->current && f->current->used > 0 && !remove) {
+    op.buf = f->current;
+    op.offset = f->queuedBytes;
+    f->queuedBytes += f->current->used;
+  } else if (f->current) {
+    QMutexLocker lock(&mutex);
+    freeBuffers.push_back(f->current);
+    bufferFree.wakeAll();
+  }
+  f->current = nullptr;
+  enqueue(std::move(op));
+}
+
+DiskWriter::Stats DiskWriter::stats() const {
+  QMutexLocker lock(&mutex);
+  return counters;
+}
+
+void DiskWriter::run() {
+  std::vector<Op> batch;
+  std::vector<Op *> writes;
+  for (;;) {
+    {
+      QMutexLocker lock(&mutex);
+      while (queue.empty() && !stopping)
+        workReady.wait(&mutex);
+      if (queue.empty() && stopping)
+        return;
+      // take everything queued so far and write it in one go
+      batch.assign(std::make_move_iterator(queue.begin()),
+                   std::make_move_iterator(queue.end()));
+      queue.clear();
+    }
+    writes.clear();
+    for (Op &op : batch) {
+      if (op.buf)
+        writes.push_back(&op);
+      if (op.close) {
+        // everything before a close, for any file, goes out first
+        writeBatch(writes);
+        writes.clear();
+        finishClose(op);
+      }
+    }
+    writeBatch(writes);
+
+    QMutexLocker lock(&mutex);
+    for (Op &op : batch) {
+      if (!op.buf)
+        continue;
+      --counters.buffersInFlight;
+      freeBuffers.push_back(op.buf);
+    }
+    bufferFree.wakeAll();
+    batch.clear();
+  }
+}
+
+void DiskWriter::writeBatch(std::vector<Op *> &writes) {
+  if (writes.empty())
+    return;
+  quint64 written = 0;
+  int errors = 0;
+#ifdef DUALITY_HAVE_IO_URING
+  if (uring) {
+    // submit up to a ring's worth of positioned writes, reap them all,
+    // finish any short write with pwrite
+    for (size_t first = 0; first < writes.size(); first += kRingDepth) {
+      const size_t count =
+          std::min<size_t>(kRingDepth, writes.size() - first);
+      for (size_t i = 0; i < count; ++i) {
+        Op *op = writes[first + i];
+        io_uring_sqe *sqe = io_uring_get_sqe(&uring->ring);
+        io_uring_prep_write(sqe, op->file->file->handle(), op->buf->data,
+                            unsigned(op->buf->used), op->offset);
+        io_uring_sqe_set_data(sqe, op);
+      }
+      io_uring_submit(&uring->ring);
+      for (size_t i = 0; i < count; ++i) {
+        io_uring_cqe *cqe = nullptr;
+        if (io_uring_wait_cqe(&uring->ring, &cqe) < 0)
+          break;
+        Op *op = static_cast<Op *>(io_uring_cqe_get_data(cqe));
+        long done = cqe->res;
+        io_uring_cqe_seen(&uring->ring, cqe);
+        size_t got = done > 0 ? size_t(done) : 0;
+        while (done >= 0 && got < op->buf->used) {
+          done = ::pwrite(op->file->file->handle(), op->buf->data + got,
+                          op->buf->used - got, off_t(op->offset + got));
+          if (done > 0)
+            got += size_t(done);
+          else if (done < 0 && errno == EINTR)
+            done = 0;
+          else
+            break;
+        }
+        if (got < op->buf->used) {
+          op->file->failed = true;
+          ++errors;
+        }
+        written += got;
+      }
+    }
+  } else
+#endif
+  {
+    // a single thread writes each file in queue order, so the sequential
+    // position equals the op's offset unless bytes were dropped before it
+    for (Op *op : writes) {
+      QFile *file = op->file->file.get();
+      if (file->pos() != qint64(op->offset) && !file->seek(qint64(op->offset)))
+        op->file->failed = true;
+      const qint64 n = file->write(op->buf->data, qint64(op->buf->used));
+      if (n != qint64(op->buf->used)) {
+        op->file->failed = true;
+        ++errors;
+      }
+      if (n > 0)
+        written += quint64(n);
+    }
+  }
+  QMutexLocker lock(&mutex);
+  counters.bytesWritten += written;
+  counters.writeErrors += errors;
+}
+
+void DiskWriter::finishClose(Op &op) {
+  std::unique_ptr<File> f(op.file);
+  const QString path = f->file->fileName();
+  // bytes dropped at the very end still take their place in the file
+  if (!op.remove && f->file->size() < qint64(f->queuedBytes) &&
+      !f->file->resize(qint64(f->queuedBytes)))
+    f->failed = true;
+  f->file->close();
+  bool dropped = false;
+  {
+    QMutexLocker lock(&mutex);
+    dropped = f->dropped;
+  }
+  if (f->failed)
+    qWarning() << "[IO] Write errors on" << path;
+  else if (dropped && !op.remove)
+    qWarning() << "[IO] Bytes dropped (left as zeros) in" << path;
+  if (op.remove)
+    QFile::remove(path);
+  if (op.onClosed)
+    op.onClosed(!f->failed);
+  op.file = nullptr;
+}
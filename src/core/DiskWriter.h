@@ -0,0 +1,102 @@
+#pragma once
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+class QFile;
+class QThread;
+
+// Owns every file the receiver writes. Producers copy into large
+// page-aligned buffers; full buffers are queued and written in order by one
+// I/O thread (batched through io_uring when built with
+// DUALITY_HAVE_IO_URING), so the thread producing samples never waits on
+// the disk. Buffer memory is bounded: once every buffer is in flight a
+// write either waits for one (Block) or is dropped and counted (Drop);
+// dropped bytes are left as zeros, so the file keeps the stream's timing.
+// A handle must only be used from one thread at a time; different handles
+// may be used from different threads.
+class DiskWriter {
+public:
+  enum Policy {
+    Drop,  // real-time producers: never wait, account for the loss
+    Block, // offline producers: wait for a buffer (backpressure)
+  };
+  struct Stats {
+    quint64 bytesWritten{0};
+    quint64 bytesDropped{0};
+    int buffersInFlight{0}; // queued or being written
+    int peakBuffersInFlight{0};
+    int writeErrors{0};
+  };
+
+  explicit DiskWriter(size_t bufferBytes = size_t(4) << 20,
+                      int maxBuffers = 32);
+  ~DiskWriter(); // writes out and closes everything still open
+
+  // Creates or truncates path. Returns a handle, or -1 if it cannot be
+  // opened.
+  int open(const QString &path, Policy policy);
+  // Appends bytes. Returns false if any of them were dropped; they are
+  // zeros in the file.
+  bool write(int handle, const void *data, size_t bytes);
+  // Queues the rest of the file and closes it once everything before it
+  // is written; with remove the file is deleted instead. onClosed runs on
+  // the I/O thread with false if any write failed.
+  void close(int handle, bool remove = false,
+             std::function<void(bool ok)> onClosed = {});
+
+  Stats stats() const;
+
+private:
+  struct Buffer {
+    char *data{nullptr};
+    size_t used{0};
+  };
+  struct File {
+    std::unique_ptr<QFile> file;
+    Policy policy{Drop};
+    Buffer *current{nullptr}; // producer side only
+    quint64 queuedBytes{0};   // producer side only: next write offset
+    bool failed{false};       // I/O thread only
+    bool dropped{false};      // set under mutex
+  };
+  struct Op {
+    File *file{nullptr};
+    Buffer *buf{nullptr}; // may be null for a bare close
+    quint64 offset{0};
+    bool close{false};
+    bool remove{false};
+    std::function<void(bool)> onClosed;
+  };
+
+  File *lookup(int handle);
+  Buffer *acquire(Policy policy);
+  void enqueue(Op op);
+  void run();
+  void writeBatch(std::vector<Op *> &writes);
+  void finishClose(Op &op);
+
+  const size_t bufferBytes;
+  const int maxBuffers;
+
+  mutable QMutex mutex;
+  QWaitCondition workReady;  // queue became non-empty / stopping
+  QWaitCondition bufferFree; // a buffer went back to the pool
+  std::map<int, std::unique_ptr<File>> files;
+  int nextHandle{1};
+  std::vector<std::unique_ptr<Buffer>> buffers; // every buffer ever made
+  std::vector<Buffer *> freeBuffers;
+  std::deque<Op> queue;
+  Stats counters;
+  bool stopping{false};
+
+  QThread *thread{nullptr};
+  struct Uring;
+  std::unique_ptr<Uring> uring; // null when io_uring is unavailable
+};
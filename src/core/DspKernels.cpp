@@ -0,0 +1,705 @@
+#include "DspKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                            \
+    (defined(__GNUC__) || defined(__clang__))
+#define DSP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct Kernels {
+  void (*windowToComplex)(const std::complex<float> *, const float *, float *,
+                          int);
+  void (*magnitude)(const float *, float, float *, int);
+  void (*power)(const float *, float, float *, int);
+  void (*smooth)(const float *, float *, float, float, float *, int);
+  void (*amplitudeToDb)(const float *, float, float *, int);
+  void (*maxHold)(float *, const float *, int);
+  float (*maxValue)(const float *, int);
+  std::complex<float> (*firDot)(const std::complex<float> *, const float *,
+                                int);
+  void (*cs8ToComplex)(const dsp::Cs8 *, float, std::complex<float> *, int);
+  const char *name;
+};
+
+// 20*log10(m) = 40/ln(10) * atanh(s), s = (m-1)/(m+1). With m reduced to
+// [sqrt(1/2), sqrt(2)) |s| < 0.172, so four odd terms are float-exact.
+constexpr float kDbPerLn2Half = 17.371779276f; // 40 / ln(10)
+constexpr float kDbPerOctave = 6.0205999133f;  // 20 * log10(2)
+constexpr float kSqrt2 = 1.41421356f;
+
+// ---- scalar: the reference every other variant must match ----
+
+void windowScalar(const std::complex<float> *in, const float *w, float *out,
+                  int n) {
+  for (int i = 0; i < n; ++i) {
+    out[2 * i] = in[i].real() * w[i];
+    out[2 * i + 1] = in[i].imag() * w[i];
+  }
+}
+
+void magnitudeScalar(const float *z, float scale, float *out, int n) {
+  for (int i = 0; i < n; ++i) {
+    float re = z[2 * i], im = z[2 * i + 1];
+    out[i] = scale * std::sqrt(re * re + im * im);
+  }
+}
+
+void powerScalar(const float *z, float scale, float *out, int n) {
+  for (int i = 0; i < n; ++i) {
+    float re = z[2 * i], im = z[2 * i + 1];
+    out[i] = scale * (re * re + im * im);
+  }
+}
+
+void smoothScalar(const float *x, float *state, float alpha, float ceiling,
+                  float *out, int n) {
+  const float beta = 1.0f - alpha;
+  for (int i = 0; i < n; ++i) {
+    float s = alpha * x[i] + beta * state[i];
+    state[i] = s;
+    out[i] = std::min(s, ceiling);
+  }
+}
+
+void amplitudeToDbScalar(const float *in, float floor, float *out, int n) {
+  for (int i = 0; i < n; ++i)
+    out[i] = 20.0f * std::log10(std::max(in[i], floor));
+}
+
+void maxHoldScalar(float *acc, const float *x, int n) {
+  for (int i = 0; i < n; ++i)
+    acc[i] = std::max(acc[i], x[i]);
+}
+
+float maxValueScalar(const float *in, int n) {
+  float m = -std::numeric_limits<float>::infinity();
+  for (int i = 0; i < n; ++i)
+    m = std::max(m, in[i]);
+  return m;
+}
+
+std::complex<float> firDotScalar(const std::complex<float> *x,
+                                 const float *hh, int taps) {
+  float re = 0.0f, im = 0.0f;
+  for (int i = 0; i < taps; ++i) {
+    re += x[i].real() * hh[2 * i];
+    im += x[i].imag() * hh[2 * i + 1];
+  }
+  return {re, im};
+}
+
+void cs8ToComplexScalar(const dsp::Cs8 *in, float scale,
+                        std::complex<float> *out, int n) {
+  for (int i = 0; i < n; ++i)
+    out[i] = {scale * float(in[i].re), scale * float(in[i].im)};
+}
+
+const Kernels kScalar{windowScalar,        magnitudeScalar, powerScalar,
+                      smoothScalar,        amplitudeToDbScalar,
+                      maxHoldScalar,       maxValueScalar,  firDotScalar,
+                      cs8ToComplexScalar,  "scalar"};
+
+#ifdef DSP_X86
+
+// ---- SSE (4 lanes) ----
+
+__attribute__((target("sse2"))) void
+windowSse(const std::complex<float> *in, const float *w, float *out, int n) {
+  const float *src = reinterpret_cast<const float *>(in);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 wv = _mm_loadu_ps(w + i);
+    __m128 a = _mm_loadu_ps(src + 2 * i);
+    __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+    _mm_storeu_ps(out + 2 * i, _mm_mul_ps(a, _mm_unpacklo_ps(wv, wv)));
+    _mm_storeu_ps(out + 2 * i + 4, _mm_mul_ps(b, _mm_unpackhi_ps(wv, wv)));
+  }
+  windowScalar(in + i, w + i, out + 2 * i, n - i);
+}
+
+__attribute__((target("sse2"))) inline __m128 normSse(const float *z) {
+  __m128 a = _mm_loadu_ps(z);
+  __m128 b = _mm_loadu_ps(z + 4);
+  __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+  return _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+}
+
+__attribute__((target("sse2"))) void magnitudeSse(const float *z, float scale,
+                                                  float *out, int n) {
+  const __m128 sv = _mm_set1_ps(scale);
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(out + i, _mm_mul_ps(sv, _mm_sqrt_ps(normSse(z + 2 * i))));
+  magnitudeScalar(z + 2 * i, scale, out + i, n - i);
+}
+
+__attribute__((target("sse2"))) void powerSse(const float *z, float scale,
+                                              float *out, int n) {
+  const __m128 sv = _mm_set1_ps(scale);
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(out + i, _mm_mul_ps(sv, normSse(z + 2 * i)));
+  powerScalar(z + 2 * i, scale, out + i, n - i);
+}
+
+__attribute__((target("sse2"))) void smoothSse(const float *x, float *state,
+                                               float alpha, float ceiling,
+                                               float *out, int n) {
+  const __m128 av = _mm_set1_ps(alpha);
+  const __m128 bv = _mm_set1_ps(1.0f - alpha);
+  const __m128 cv = _mm_set1_ps(ceiling);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 s = _mm_add_ps(_mm_mul_ps(av, _mm_loadu_ps(x + i)),
+                          _mm_mul_ps(bv, _mm_loadu_ps(state + i)));
+    _mm_storeu_ps(state + i, s);
+    _mm_storeu_ps(out + i, _mm_min_ps(s, cv));
+  }
+  smoothScalar(x + i, state + i, alpha, ceiling, out + i, n - i);
+}
+
+__attribute__((target("sse2"))) void
+amplitudeToDbSse(const float *in, float floor, float *out, int n) {
+  const __m128 fv = _mm_set1_ps(floor);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 sqrt2 = _mm_set1_ps(kSqrt2);
+  const __m128i mantMask = _mm_set1_epi32(0x007fffff);
+  const __m128i oneBits = _mm_set1_epi32(0x3f800000);
+  const __m128i bias = _mm_set1_epi32(127);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 x = _mm_max_ps(_mm_loadu_ps(in + i), fv);
+    __m128i bits = _mm_castps_si128(x);
+    __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+    __m128 m = _mm_castsi128_ps(
+        _mm_or_si128(_mm_and_si128(bits, mantMask), oneBits));
+    __m128 big = _mm_cmpgt_ps(m, sqrt2);
+    m = _mm_or_ps(_mm_and_ps(big, _mm_mul_ps(m, half)), _mm_andnot_ps(big, m));
+    e = _mm_add_ps(e, _mm_and_ps(big, one));
+    __m128 s = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+    __m128 s2 = _mm_mul_ps(s, s);
+    __m128 p = _mm_add_ps(_mm_set1_ps(1.0f / 5.0f),
+                          _mm_mul_ps(s2, _mm_set1_ps(1.0f / 7.0f)));
+    p = _mm_add_ps(_mm_set1_ps(1.0f / 3.0f), _mm_mul_ps(s2, p));
+    p = _mm_add_ps(one, _mm_mul_ps(s2, p));
+    __m128 db = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kDbPerOctave), e),
+                           _mm_mul_ps(_mm_set1_ps(kDbPerLn2Half),
+                                      _mm_mul_ps(s, p)));
+    _mm_storeu_ps(out + i, db);
+  }
+  amplitudeToDbScalar(in + i, floor, out + i, n - i);
+}
+
+__attribute__((target("sse2"))) void maxHoldSse(float *acc, const float *x,
+                                                int n) {
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(acc + i,
+                  _mm_max_ps(_mm_loadu_ps(acc + i), _mm_loadu_ps(x + i)));
+  maxHoldScalar(acc + i, x + i, n - i);
+}
+
+__attribute__((target("sse2"))) float maxValueSse(const float *in, int n) {
+  if (n < 4)
+    return maxValueScalar(in, n);
+  __m128 m = _mm_loadu_ps(in);
+  int i = 4;
+  for (; i + 4 <= n; i += 4)
+    m = _mm_max_ps(m, _mm_loadu_ps(in + i));
+  m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+  m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+  return std::max(_mm_cvtss_f32(m), maxValueScalar(in + i, n - i));
+}
+
+// lanes hold re im re im; two accumulators hide the add latency
+__attribute__((target("sse2"))) std::complex<float>
+firDotSse(const std::complex<float> *x, const float *hh, int taps) {
+  const float *src = reinterpret_cast<const float *>(x);
+  __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+  int i = 0;
+  for (; i + 4 <= taps; i += 4) {
+    a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(src + 2 * i),
+                                   _mm_loadu_ps(hh + 2 * i)));
+    a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(src + 2 * i + 4),
+                                   _mm_loadu_ps(hh + 2 * i + 4)));
+  }
+  __m128 a = _mm_add_ps(a0, a1);
+  a = _mm_add_ps(a, _mm_movehl_ps(a, a)); // re im in lanes 0, 1
+  alignas(16) float lanes[4];
+  _mm_store_ps(lanes, a);
+  const std::complex<float> tail = firDotScalar(x + i, hh + 2 * i, taps - i);
+  return {lanes[0] + tail.real(), lanes[1] + tail.imag()};
+}
+
+// sign-extends 16 bytes by interleaving each with itself and shifting the
+// copy back down (SSE2 has no pmovsx)
+__attribute__((target("sse2"))) void
+cs8ToComplexSse(const dsp::Cs8 *in, float scale, std::complex<float> *out,
+                int n) {
+  const __m128 k = _mm_set1_ps(scale);
+  const char *src = reinterpret_cast<const char *>(in);
+  float *dst = reinterpret_cast<float *>(out);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+    const __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+    const __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+    const __m128i q[4] = {_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16),
+                          _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16),
+                          _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16),
+                          _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)};
+    for (int j = 0; j < 4; ++j)
+      _mm_storeu_ps(dst + 2 * i + 4 * j,
+                    _mm_mul_ps(_mm_cvtepi32_ps(q[j]), k));
+  }
+  cs8ToComplexScalar(in + i, scale, out + i, n - i);
+}
+
+const Kernels kSse{windowSse,        magnitudeSse, powerSse,    smoothSse,
+                   amplitudeToDbSse, maxHoldSse,   maxValueSse, firDotSse,
+                   cs8ToComplexSse,  "sse2"};
+
+// ---- AVX2 + FMA (8 lanes) ----
+
+__attribute__((target("avx2,fma"))) void
+windowAvx2(const std::complex<float> *in, const float *w, float *out, int n) {
+  const float *src = reinterpret_cast<const float *>(in);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 wv = _mm256_loadu_ps(w + i);
+    __m256 lo = _mm256_unpacklo_ps(wv, wv); // w0 w0 w1 w1 | w4 w4 w5 w5
+    __m256 hi = _mm256_unpackhi_ps(wv, wv); // w2 w2 w3 w3 | w6 w6 w7 w7
+    __m256 w03 = _mm256_permute2f128_ps(lo, hi, 0x20);
+    __m256 w47 = _mm256_permute2f128_ps(lo, hi, 0x31);
+    _mm256_storeu_ps(out + 2 * i,
+                     _mm256_mul_ps(_mm256_loadu_ps(src + 2 * i), w03));
+    _mm256_storeu_ps(out + 2 * i + 8,
+                     _mm256_mul_ps(_mm256_loadu_ps(src + 2 * i + 8), w47));
+  }
+  windowSse(in + i, w + i, out + 2 * i, n - i);
+}
+
+// |z|^2 for 8 complex values, in order
+__attribute__((target("avx2,fma"))) inline __m256 normAvx2(const float *z) {
+  __m256 a = _mm256_loadu_ps(z);
+  __m256 b = _mm256_loadu_ps(z + 8);
+  __m256 re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  __m256 im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+  __m256 p = _mm256_fmadd_ps(re, re, _mm256_mul_ps(im, im));
+  // in-lane shuffles leave pairs as 01 45 23 67
+  return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(p),
+                                                _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+__attribute__((target("avx2,fma"))) void
+magnitudeAvx2(const float *z, float scale, float *out, int n) {
+  const __m256 sv = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(out + i,
+                     _mm256_mul_ps(sv, _mm256_sqrt_ps(normAvx2(z + 2 * i))));
+  magnitudeSse(z + 2 * i, scale, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma"))) void powerAvx2(const float *z,
+                                                   float scale, float *out,
+                                                   int n) {
+  const __m256 sv = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(sv, normAvx2(z + 2 * i)));
+  powerSse(z + 2 * i, scale, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma"))) void
+smoothAvx2(const float *x, float *state, float alpha, float ceiling,
+           float *out, int n) {
+  const __m256 av = _mm256_set1_ps(alpha);
+  const __m256 bv = _mm256_set1_ps(1.0f - alpha);
+  const __m256 cv = _mm256_set1_ps(ceiling);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 s = _mm256_fmadd_ps(av, _mm256_loadu_ps(x + i),
+                               _mm256_mul_ps(bv, _mm256_loadu_ps(state + i)));
+    _mm256_storeu_ps(state + i, s);
+    _mm256_storeu_ps(out + i, _mm256_min_ps(s, cv));
+  }
+  smoothSse(x + i, state + i, alpha, ceiling, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma"))) void
+amplitudeToDbAvx2(const float *in, float floor, float *out, int n) {
+  const __m256 fv = _mm256_set1_ps(floor);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 sqrt2 = _mm256_set1_ps(kSqrt2);
+  const __m256i mantMask = _mm256_set1_epi32(0x007fffff);
+  const __m256i oneBits = _mm256_set1_epi32(0x3f800000);
+  const __m256i bias = _mm256_set1_epi32(127);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 x = _mm256_max_ps(_mm256_loadu_ps(in + i), fv);
+    __m256i bits = _mm256_castps_si256(x);
+    __m256 e = _mm256_cvtepi32_ps(
+        _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), bias));
+    __m256 m = _mm256_castsi256_ps(
+        _mm256_or_si256(_mm256_and_si256(bits, mantMask), oneBits));
+    __m256 big = _mm256_cmp_ps(m, sqrt2, _CMP_GT_OQ);
+    m = _mm256_blendv_ps(m, _mm256_mul_ps(m, half), big);
+    e = _mm256_add_ps(e, _mm256_and_ps(big, one));
+    __m256 s = _mm256_div_ps(_mm256_sub_ps(m, one), _mm256_add_ps(m, one));
+    __m256 s2 = _mm256_mul_ps(s, s);
+    __m256 p = _mm256_fmadd_ps(s2, _mm256_set1_ps(1.0f / 7.0f),
+                               _mm256_set1_ps(1.0f / 5.0f));
+    p = _mm256_fmadd_ps(s2, p, _mm256_set1_ps(1.0f / 3.0f));
+    p = _mm256_fmadd_ps(s2, p, one);
+    __m256 db = _mm256_fmadd_ps(
+        _mm256_set1_ps(kDbPerOctave), e,
+        _mm256_mul_ps(_mm256_set1_ps(kDbPerLn2Half), _mm256_mul_ps(s, p)));
+    _mm256_storeu_ps(out + i, db);
+  }
+  amplitudeToDbSse(in + i, floor, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma"))) void maxHoldAvx2(float *acc,
+                                                     const float *x, int n) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(acc + i, _mm256_max_ps(_mm256_loadu_ps(acc + i),
+                                            _mm256_loadu_ps(x + i)));
+  maxHoldSse(acc + i, x + i, n - i);
+}
+
+__attribute__((target("avx2,fma"))) float maxValueAvx2(const float *in,
+                                                       int n) {
+  if (n < 8)
+    return maxValueSse(in, n);
+  __m256 m = _mm256_loadu_ps(in);
+  int i = 8;
+  for (; i + 8 <= n; i += 8)
+    m = _mm256_max_ps(m, _mm256_loadu_ps(in + i));
+  __m128 h = _mm_max_ps(_mm256_castps256_ps128(m),
+                        _mm256_extractf128_ps(m, 1));
+  h = _mm_max_ps(h, _mm_shuffle_ps(h, h, _MM_SHUFFLE(1, 0, 3, 2)));
+  h = _mm_max_ps(h, _mm_shuffle_ps(h, h, _MM_SHUFFLE(2, 3, 0, 1)));
+  return std::max(_mm_cvtss_f32(h), maxValueSse(in + i, n - i));
+}
+
+__attribute__((target("avx2,fma"))) std::complex<float>
+firDotAvx2(const std::complex<float> *x, const float *hh, int taps) {
+  const float *src = reinterpret_cast<const float *>(x);
+  __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + 8 <= taps; i += 8) {
+    a0 = _mm256_fmadd_ps(_mm256_loadu_ps(src + 2 * i),
+                         _mm256_loadu_ps(hh + 2 * i), a0);
+    a1 = _mm256_fmadd_ps(_mm256_loadu_ps(src + 2 * i + 8),
+                         _mm256_loadu_ps(hh + 2 * i + 8), a1);
+  }
+  __m256 a = _mm256_add_ps(a0, a1);
+  __m128 h = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+  alignas(16) float lanes[4];
+  _mm_store_ps(lanes, h);
+  const std::complex<float> tail = firDotSse(x + i, hh + 2 * i, taps - i);
+  return {lanes[0] + tail.real(), lanes[1] + tail.imag()};
+}
+
+__attribute__((target("avx2,fma"))) void
+cs8ToComplexAvx2(const dsp::Cs8 *in, float scale, std::complex<float> *out,
+                 int n) {
+  const __m256 k = _mm256_set1_ps(scale);
+  const char *src = reinterpret_cast<const char *>(in);
+  float *dst = reinterpret_cast<float *>(out);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+    const __m256i lo = _mm256_cvtepi8_epi32(v);
+    const __m256i hi = _mm256_cvtepi8_epi32(_mm_unpackhi_epi64(v, v));
+    _mm256_storeu_ps(dst + 2 * i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), k));
+    _mm256_storeu_ps(dst + 2 * i + 8,
+                     _mm256_mul_ps(_mm256_cvtepi32_ps(hi), k));
+  }
+  cs8ToComplexSse(in + i, scale, out + i, n - i);
+}
+
+const Kernels kAvx2{windowAvx2,        magnitudeAvx2, powerAvx2,
+                    smoothAvx2,        amplitudeToDbAvx2,
+                    maxHoldAvx2,       maxValueAvx2,  firDotAvx2,
+                    cs8ToComplexAvx2,  "avx2"};
+
+// ---- AVX-512F (16 lanes) ----
+
+__attribute__((target("avx512f"))) void
+windowAvx512(const std::complex<float> *in, const float *w, float *out,
+             int n) {
+  const float *src = reinterpret_cast<const float *>(in);
+  const __m512i dupLo =
+      _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+  const __m512i dupHi = _mm512_setr_epi32(8, 8, 9, 9, 10, 10, 11, 11, 12, 12,
+                                          13, 13, 14, 14, 15, 15);
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 wv = _mm512_loadu_ps(w + i);
+    _mm512_storeu_ps(out + 2 * i,
+                     _mm512_mul_ps(_mm512_loadu_ps(src + 2 * i),
+                                   _mm512_permutexvar_ps(dupLo, wv)));
+    _mm512_storeu_ps(out + 2 * i + 16,
+                     _mm512_mul_ps(_mm512_loadu_ps(src + 2 * i + 16),
+                                   _mm512_permutexvar_ps(dupHi, wv)));
+  }
+  windowAvx2(in + i, w + i, out + 2 * i, n - i);
+}
+
+// |z|^2 for 16 complex values, in order
+__attribute__((target("avx512f"))) inline __m512 normAvx512(const float *z) {
+  __m512 a = _mm512_loadu_ps(z);
+  __m512 b = _mm512_loadu_ps(z + 16);
+  __m512 re = _mm512_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  __m512 im = _mm512_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+  __m512 p = _mm512_fmadd_ps(re, re, _mm512_mul_ps(im, im));
+  // pairs come out interleaved between a and b per 128-bit lane
+  const __m512i order = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+  return _mm512_castpd_ps(
+      _mm512_permutexvar_pd(order, _mm512_castps_pd(p)));
+}
+
+__attribute__((target("avx512f"))) void
+magnitudeAvx512(const float *z, float scale, float *out, int n) {
+  const __m512 sv = _mm512_set1_ps(scale);
+  int i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(out + i,
+                     _mm512_mul_ps(sv, _mm512_sqrt_ps(normAvx512(z + 2 * i))));
+  magnitudeAvx2(z + 2 * i, scale, out + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void powerAvx512(const float *z,
+                                                    float scale, float *out,
+                                                    int n) {
+  const __m512 sv = _mm512_set1_ps(scale);
+  int i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(out + i, _mm512_mul_ps(sv, normAvx512(z + 2 * i)));
+  powerAvx2(z + 2 * i, scale, out + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void
+smoothAvx512(const float *x, float *state, float alpha, float ceiling,
+             float *out, int n) {
+  const __m512 av = _mm512_set1_ps(alpha);
+  const __m512 bv = _mm512_set1_ps(1.0f - alpha);
+  const __m512 cv = _mm512_set1_ps(ceiling);
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 s = _mm512_fmadd_ps(av, _mm512_loadu_ps(x + i),
+                               _mm512_mul_ps(bv, _mm512_loadu_ps(state + i)));
+    _mm512_storeu_ps(state + i, s);
+    _mm512_storeu_ps(out + i, _mm512_min_ps(s, cv));
+  }
+  smoothAvx2(x + i, state + i, alpha, ceiling, out + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void
+amplitudeToDbAvx512(const float *in, float floor, float *out, int n) {
+  const __m512 fv = _mm512_set1_ps(floor);
+  const __m512 one = _mm512_set1_ps(1.0f);
+  const __m512 half = _mm512_set1_ps(0.5f);
+  const __m512 sqrt2 = _mm512_set1_ps(kSqrt2);
+  const __m512i mantMask = _mm512_set1_epi32(0x007fffff);
+  const __m512i oneBits = _mm512_set1_epi32(0x3f800000);
+  const __m512i bias = _mm512_set1_epi32(127);
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 x = _mm512_max_ps(_mm512_loadu_ps(in + i), fv);
+    __m512i bits = _mm512_castps_si512(x);
+    __m512 e = _mm512_cvtepi32_ps(
+        _mm512_sub_epi32(_mm512_srli_epi32(bits, 23), bias));
+    __m512 m = _mm512_castsi512_ps(
+        _mm512_or_si512(_mm512_and_si512(bits, mantMask), oneBits));
+    __mmask16 big = _mm512_cmp_ps_mask(m, sqrt2, _CMP_GT_OQ);
+    m = _mm512_mask_mul_ps(m, big, m, half);
+    e = _mm512_mask_add_ps(e, big, e, one);
+    __m512 s = _mm512_div_ps(_mm512_sub_ps(m, one), _mm512_add_ps(m, one));
+    __m512 s2 = _mm512_mul_ps(s, s);
+    __m512 p = _mm512_fmadd_ps(s2, _mm512_set1_ps(1.0f / 7.0f),
+                               _mm512_set1_ps(1.0f / 5.0f));
+    p = _mm512_fmadd_ps(s2, p, _mm512_set1_ps(1.0f / 3.0f));
+    p = _mm512_fmadd_ps(s2, p, one);
+    __m512 db = _mm512_fmadd_ps(
+        _mm512_set1_ps(kDbPerOctave), e,
+        _mm512_mul_ps(_mm512_set1_ps(kDbPerLn2Half), _mm512_mul_ps(s, p)));
+    _mm512_storeu_ps(out + i, db);
+  }
+  amplitudeToDbAvx2(in + i, floor, out + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void maxHoldAvx512(float *acc,
+                                                      const float *x, int n) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(acc + i, _mm512_max_ps(_mm512_loadu_ps(acc + i),
+                                            _mm512_loadu_ps(x + i)));
+  maxHoldAvx2(acc + i, x + i, n - i);
+}
+
+__attribute__((target("avx512f"))) float maxValueAvx512(const float *in,
+                                                        int n) {
+  if (n < 16)
+    return maxValueAvx2(in, n);
+  __m512 m = _mm512_loadu_ps(in);
+  int i = 16;
+  for (; i + 16 <= n; i += 16)
+    m = _mm512_max_ps(m, _mm512_loadu_ps(in + i));
+  return std::max(_mm512_reduce_max_ps(m), maxValueAvx2(in + i, n - i));
+}
+
+__attribute__((target("avx512f"))) std::complex<float>
+firDotAvx512(const std::complex<float> *x, const float *hh, int taps) {
+  const float *src = reinterpret_cast<const float *>(x);
+  __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+  int i = 0;
+  for (; i + 16 <= taps; i += 16) {
+    a0 = _mm512_fmadd_ps(_mm512_loadu_ps(src + 2 * i),
+                         _mm512_loadu_ps(hh + 2 * i), a0);
+    a1 = _mm512_fmadd_ps(_mm512_loadu_ps(src + 2 * i + 16),
+                         _mm512_loadu_ps(hh + 2 * i + 16), a1);
+  }
+  // even lanes are re, odd lanes im
+  const __m512 a = _mm512_add_ps(a0, a1);
+  const float re = _mm512_mask_reduce_add_ps(__mmask16(0x5555), a);
+  const float im = _mm512_mask_reduce_add_ps(__mmask16(0xAAAA), a);
+  const std::complex<float> tail = firDotAvx2(x + i, hh + 2 * i, taps - i);
+  return {re + tail.real(), im + tail.imag()};
+}
+
+__attribute__((target("avx512f"))) void
+cs8ToComplexAvx512(const dsp::Cs8 *in, float scale, std::complex<float> *out,
+                   int n) {
+  const __m512 k = _mm512_set1_ps(scale);
+  const char *src = reinterpret_cast<const char *>(in);
+  float *dst = reinterpret_cast<float *>(out);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m512i v = _mm512_cvtepi8_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i)));
+    _mm512_storeu_ps(dst + 2 * i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), k));
+  }
+  cs8ToComplexAvx2(in + i, scale, out + i, n - i);
+}
+
+const Kernels kAvx512{windowAvx512,        magnitudeAvx512, powerAvx512,
+                      smoothAvx512,        amplitudeToDbAvx512,
+                      maxHoldAvx512,       maxValueAvx512,  firDotAvx512,
+                      cs8ToComplexAvx512,  "avx512"};
+
+#endif // DSP_X86
+
+const Kernels &pick() {
+#ifdef DSP_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return kAvx512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return kAvx2;
+  if (__builtin_cpu_supports("sse2"))
+    return kSse;
+#endif
+  return kScalar;
+}
+
+const Kernels *&current() {
+  static const Kernels *k = &pick();
+  return k;
+}
+
+const Kernels &active() { return *current(); }
+
+// every variant this CPU can run, fastest last
+std::vector<const Kernels *> runnable() {
+  std::vector<const Kernels *> out{&kScalar};
+#ifdef DSP_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    out.push_back(&kSse);
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    out.push_back(&kAvx2);
+  if (__builtin_cpu_supports("avx512f"))
+    out.push_back(&kAvx512);
+#endif
+  return out;
+}
+
+} // namespace
+
+namespace dsp {
+
+void windowToComplex(const std::complex<float> *in, const float *w, float *out,
+                     int n) {
+  active().windowToComplex(in, w, out, n);
+}
+
+void magnitude(const float *z, float scale, float *out, int n) {
+  active().magnitude(z, scale, out, n);
+}
+
+void power(const float *z, float scale, float *out, int n) {
+  active().power(z, scale, out, n);
+}
+
+void smooth(const float *x, float *state, float alpha, float ceiling,
+            float *out, int n) {
+  active().smooth(x, state, alpha, ceiling, out, n);
+}
+
+void amplitudeToDb(const float *in, float floor, float *out, int n) {
+  active().amplitudeToDb(in, floor, out, n);
+}
+
+void maxHold(float *acc, const float *x, int n) {
+  active().maxHold(acc, x, n);
+}
+
+float maxValue(const float *in, int n) { return active().maxValue(in, n); }
+
+std::complex<float> firDot(const std::complex<float> *x, const float *hh,
+                           int taps) {
+  return active().firDot(x, hh, taps);
+}
+
+void cs8ToComplex(const Cs8 *in, float scale, std::complex<float> *out,
+                  int n) {
+  active().cs8ToComplex(in, scale, out, n);
+}
+
+const char *isaName() { return active().name; }
+
+std::vector<const char *> supportedIsas() {
+  std::vector<const char *> names;
+  for (const Kernels *k : runnable())
+    names.push_back(k->name);
+  return names;
+}
+
+bool selectIsa(const char *name) {
+  for (const Kernels *k : runnable()) {
+    if (std::strcmp(k->name, name) == 0) {
+      current() = k;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace dsp
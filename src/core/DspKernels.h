@@ -0,0 +1,51 @@
+#pragma once
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+// Vectorised kernels for the spectrum and capture filter paths. Each call
+// goes through a table picked once at startup from what the CPU supports
+// (AVX-512, AVX2, SSE or plain scalar), so one binary runs everywhere.
+// Buffers need no particular alignment.
+namespace dsp {
+
+// One interleaved 8-bit IQ sample, as a SOAPY_SDR_CS8 stream delivers it.
+struct Cs8 {
+  int8_t re, im;
+};
+
+// out[2i], out[2i+1] = re, im of in[i] * w[i]; `out` is interleaved complex
+// (fftwf_complex compatible).
+void windowToComplex(const std::complex<float> *in, const float *w, float *out,
+                     int n);
+// out[i] = scale * |z[i]| for interleaved complex z
+void magnitude(const float *z, float scale, float *out, int n);
+// out[i] = scale * |z[i]|^2 for interleaved complex z
+void power(const float *z, float scale, float *out, int n);
+// state[i] = alpha * x[i] + (1 - alpha) * state[i]; out[i] = min(state[i],
+// ceiling). `out` may alias `x`.
+void smooth(const float *x, float *state, float alpha, float ceiling,
+            float *out, int n);
+// out[i] = 20 * log10(max(in[i], floor)) for linear amplitudes
+void amplitudeToDb(const float *in, float floor, float *out, int n);
+// acc[i] = max(acc[i], x[i])
+void maxHold(float *acc, const float *x, int n);
+// Largest of in[0..n); -inf for n <= 0.
+float maxValue(const float *in, int n);
+// sum over i < taps of x[i] * h[i] for complex x and real taps, where
+// hh holds every tap twice (h0 h0 h1 h1 ...) to line up with re/im pairs.
+std::complex<float> firDot(const std::complex<float> *x, const float *hh,
+                           int taps);
+// out[i] = scale * in[i] for 8-bit IQ; scale = 1/128 maps full scale to 1.
+void cs8ToComplex(const Cs8 *in, float scale, std::complex<float> *out,
+                  int n);
+
+// Name of the variant in use, for logging.
+const char *isaName();
+// Variants this CPU can run ("scalar" first), and switching to one of
+// them by name; false if it cannot run here. For tests and benchmarks:
+// not safe while other threads are calling kernels.
+std::vector<const char *> supportedIsas();
+bool selectIsa(const char *name);
+
+} // namespace dsp
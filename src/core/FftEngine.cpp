@@ -0,0 +1,97 @@
+#include "FftEngine.h"
+#include "FftPlanCache.h"
+#include <QSemaphore>
+#include <algorithm>
+
+namespace {
+// Frames per plan_many call: big enough to amortise the call, small enough
+// that a batch still splits evenly across cores.
+constexpr int kChunkFrames = 4;
+} // namespace
+
+FftEngine::FftEngine() { restartThreads(); }
+
+FftEngine::~FftEngine() {
+  pool->waitForDone();
+  release();
+}
+
+void FftEngine::release() {
+  if (in)
+    fftwf_free(in);
+  if (out)
+    fftwf_free(out);
+  in = out = nullptr;
+  slotCount = 0;
+}
+
+void FftEngine::configure(int fftSize, int maxFrames) {
+  maxFrames = std::max(1, maxFrames);
+  if (fftSize == n && maxFrames == slotCount)
+    return;
+  pool->waitForDone();
+  release();
+  n = fftSize;
+  slotCount = maxFrames;
+  const size_t total = size_t(n) * size_t(slotCount);
+  in = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * total);
+  out = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * total);
+  chunk = std::min(kChunkFrames, slotCount);
+  single = FftPlanCache::instance().acquire(n, FFTW_FORWARD);
+  many = chunk > 1 ? FftPlanCache::instance().acquire(n, FFTW_FORWARD, chunk)
+                   : single;
+}
+
+void FftEngine::setThreadCount(int count) {
+  threads = std::max(1, count);
+  // the calling thread always takes one share of the batch itself
+  pool->setMaxThreadCount(std::max(1, threads - 1));
+}
+
+void FftEngine::restartThreads() {
+  // the old pool waits for its threads as it goes
+  pool = std::make_unique<QThreadPool>();
+  pool->setObjectName("FftEngine");
+  pool->setMaxThreadCount(std::max(1, threads - 1));
+}
+
+void FftEngine::runChunk(int first, int count) {
+  // slots are n-aligned offsets into fftwf_malloc'd arrays, so they keep the
+  // alignment the cached plans were made with
+  int f = first;
+  const int end = first + count;
+  if (chunk > 1) {
+    fftwf_plan p = many->get();
+    for (; f + chunk <= end; f += chunk)
+      fftwf_execute_dft(p, input(f), out + size_t(f) * size_t(n));
+  }
+  fftwf_plan p = single->get();
+  for (; f < end; ++f)
+    fftwf_execute_dft(p, input(f), out + size_t(f) * size_t(n));
+}
+
+void FftEngine::execute(int frames) {
+  frames = std::clamp(frames, 0, slotCount);
+  if (frames == 0)
+    return;
+  // split into per-thread shares made of whole chunks
+  const int chunks = (frames + chunk - 1) / chunk;
+  const int shares = std::min(threads, chunks);
+  if (shares <= 1) {
+    runChunk(0, frames);
+    return;
+  }
+  const int perShare = ((chunks + shares - 1) / shares) * chunk;
+  QSemaphore done;
+  int queued = 0;
+  for (int first = perShare; first < frames; first += perShare) {
+    const int count = std::min(perShare, frames - first);
+    pool->start([this, first, count, &done]() {
+      runChunk(first, count);
+      done.release();
+    });
+    ++queued;
+  }
+  runChunk(0, std::min(perShare, frames));
+  done.acquire(queued);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <QThreadPool>
+#include <fftw3.h>
+#include <memory>
+
+class FftPlan;
+
+// Batched forward FFT engine. Frames are staged back to back in input()
+// slots and transformed together: the batch is cut into chunks that run as
+// fftwf_plan_many_dft plans across a thread pool, and each result lands in
+// the output() slot of its frame, so callers read them back in order.
+class FftEngine {
+public:
+  FftEngine();
+  ~FftEngine();
+
+  // (Re)allocates slots for up to maxFrames frames of fftSize points.
+  void configure(int fftSize, int maxFrames);
+  void setThreadCount(int threads);
+  // Retires the pool's threads; the next batch starts new ones from the
+  // calling thread, so they take on its current CPU affinity.
+  void restartThreads();
+  int fftSize() const { return n; }
+  int capacity() const { return slotCount; }
+  int threadCount() const { return threads; }
+
+  fftwf_complex *input(int frame) { return in + size_t(frame) * size_t(n); }
+  const fftwf_complex *output(int frame) const {
+    return out + size_t(frame) * size_t(n);
+  }
+
+  // Transforms input slots [0, frames) into the matching output slots.
+  void execute(int frames);
+
+private:
+  void release();
+  void runChunk(int first, int count);
+
+  int n{0};
+  int slotCount{0};
+  int threads{1};
+  int chunk{1}; // frames per plan_many call
+  fftwf_complex *in{nullptr};
+  fftwf_complex *out{nullptr};
+  const FftPlan *single{nullptr};
+  const FftPlan *many{nullptr};
+  std::unique_ptr<QThreadPool> pool;
+};
@@ -0,0 +1,147 @@
+#include "FftPlanCache.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+// FFTW's planner (plan creation/destruction and wisdom) is not thread-safe;
+// only the execute functions are. Every planner call goes through here.
+QMutex plannerMutex;
+} // namespace
+
+FftPlanCache &FftPlanCache::instance() {
+  static FftPlanCache cache;
+  return cache;
+}
+
+FftPlanCache::FftPlanCache() {
+  planner.setMaxThreadCount(1);
+  planner.setObjectName("FftPlanner");
+}
+
+FftPlanCache::~FftPlanCache() {
+  planner.clear();
+  planner.waitForDone();
+  QMutexLocker lock(&plannerMutex);
+  for (auto &kv : plans) {
+    FftPlan *p = kv.second.get();
+    if (fftwf_plan cur = p->current.load(std::memory_order_acquire))
+      fftwf_destroy_plan(cur);
+    for (fftwf_plan old : p->retired)
+      fftwf_destroy_plan(old);
+  }
+  plans.clear();
+}
+
+fftwf_plan FftPlanCache::makePlan(int n, int sign, int howmany,
+                                  unsigned flags) {
+  // MEASURE overwrites its arrays, so plan on scratch buffers with the same
+  // fftwf_malloc alignment callers use.
+  const size_t total = size_t(n) * size_t(howmany);
+  auto *a = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * total);
+  auto *b = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * total);
+  fftwf_plan p = nullptr;
+  {
+    QMutexLocker lock(&plannerMutex);
+    if (howmany == 1)
+      p = fftwf_plan_dft_1d(n, a, b, sign, flags);
+    else
+      p = fftwf_plan_many_dft(1, &n, howmany, a, nullptr, 1, n, b, nullptr, 1,
+                              n, sign, flags);
+  }
+  fftwf_free(a);
+  fftwf_free(b);
+  return p;
+}
+
+const FftPlan *FftPlanCache::acquire(int n, int sign, int howmany) {
+  howmany = std::max(1, howmany);
+  QMutexLocker lock(&mutex);
+  std::unique_ptr<FftPlan> &slot = plans[{n, sign, howmany}];
+  if (slot)
+    return slot.get();
+  slot = std::make_unique<FftPlan>();
+  FftPlan *p = slot.get();
+  p->n = n;
+  p->sign = sign;
+  p->howmany = howmany;
+  // Wisdom from a previous run gives us the measured plan for free
+  if (fftwf_plan wise =
+          makePlan(n, sign, howmany, FFTW_MEASURE | FFTW_WISDOM_ONLY)) {
+    p->current.store(wise, std::memory_order_release);
+    p->measured.store(true, std::memory_order_release);
+    return p;
+  }
+  p->current.store(makePlan(n, sign, howmany, FFTW_ESTIMATE),
+                   std::memory_order_release);
+  scheduleMeasure(p);
+  return p;
+}
+
+void FftPlanCache::scheduleMeasure(FftPlan *p) {
+  planner.start([this, p]() {
+    QElapsedTimer t;
+    t.start();
+    fftwf_plan measured = makePlan(p->n, p->sign, p->howmany, FFTW_MEASURE);
+    if (!measured)
+      return;
+    QMutexLocker lock(&mutex);
+    // Swap in; the estimate may still be executing elsewhere, so keep it
+    // alive until shutdown instead of destroying it here.
+    fftwf_plan old = p->current.exchange(measured, std::memory_order_acq_rel);
+    if (old)
+      p->retired.push_back(old);
+    p->measured.store(true, std::memory_order_release);
+    qInfo() << "[FFT] MEASURE plan ready N=" << p->n
+            << "dir=" << (p->sign == FFTW_FORWARD ? "fwd" : "inv")
+            << "batch=" << p->howmany
+            << "ms=" << t.elapsed();
+  });
+}
+
+void FftPlanCache::prewarm(const std::vector<int> &sizes, int sign,
+                           int howmany) {
+  for (int n : sizes)
+    acquire(n, sign, howmany);
+}
+
+QString FftPlanCache::wisdomPath() {
+  QString dir =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+  if (dir.isEmpty())
+    dir = ".";
+  return dir + "/fftwf_wisdom.dat";
+}
+
+void FftPlanCache::loadWisdom() {
+  const QString path = wisdomPath();
+  if (!QFile::exists(path))
+    return;
+  int ok = 0;
+  {
+    QMutexLocker lock(&plannerMutex);
+    ok = fftwf_import_wisdom_from_filename(QFile::encodeName(path).constData());
+  }
+  qInfo() << "[FFT] Wisdom" << (ok ? "loaded from" : "failed to load from")
+          << path;
+}
+
+void FftPlanCache::saveWisdom() {
+  // drop queued sizes nobody waited for, finish the one being measured
+  planner.clear();
+  planner.waitForDone();
+  const QString path = wisdomPath();
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  int ok = 0;
+  {
+    QMutexLocker lock(&plannerMutex);
+    ok = fftwf_export_wisdom_to_filename(QFile::encodeName(path).constData());
+  }
+  if (!ok)
+    qWarning() << "[FFT] Failed to save wisdom to" << path;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <fftw3.h>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+// Cached plan for one (size, direction, batch). Plans are executed with
+// fftwf_execute_dft() on the caller's fftwf_malloc'd out-of-place buffers,
+// never with fftwf_execute(): the arrays used for planning are scratch.
+// Batched plans transform `batch()` contiguous frames of size() each.
+class FftPlan {
+public:
+  // Re-read before every execute; a measured plan replaces the estimate
+  // as soon as background planning finishes.
+  fftwf_plan get() const { return current.load(std::memory_order_acquire); }
+  int size() const { return n; }
+  int direction() const { return sign; }
+  int batch() const { return howmany; }
+  bool isMeasured() const { return measured.load(std::memory_order_acquire); }
+
+private:
+  friend class FftPlanCache;
+  int n{0};
+  int sign{FFTW_FORWARD};
+  int howmany{1};
+  std::atomic<fftwf_plan> current{nullptr};
+  std::atomic<bool> measured{false};
+  std::vector<fftwf_plan> retired; // superseded plans, freed at shutdown
+};
+
+// Process-wide FFTW plan cache. The first request for a size returns an
+// FFTW_ESTIMATE plan immediately (or a measured one if wisdom covers it)
+// and queues FFTW_MEASURE planning on a background thread. Wisdom is
+// persisted between runs so measuring only happens once per machine.
+class FftPlanCache {
+public:
+  static FftPlanCache &instance();
+
+  // Thread-safe. The returned plan lives until process exit. howmany > 1
+  // gives an fftwf_plan_many_dft plan over back-to-back frames.
+  const FftPlan *acquire(int n, int sign, int howmany = 1);
+  // Plans sizes ahead of time so switching to them costs nothing.
+  void prewarm(const std::vector<int> &sizes, int sign, int howmany = 1);
+
+  void loadWisdom();
+  // Waits for in-flight planning, then exports wisdom.
+  void saveWisdom();
+  static QString wisdomPath();
+
+private:
+  FftPlanCache();
+  ~FftPlanCache();
+  FftPlanCache(const FftPlanCache &) = delete;
+  FftPlanCache &operator=(const FftPlanCache &) = delete;
+
+  static fftwf_plan makePlan(int n, int sign, int howmany, unsigned flags);
+  void scheduleMeasure(FftPlan *plan);
+
+  QMutex mutex;
+  std::map<std::tuple<int, int, int>, std::unique_ptr<FftPlan>> plans;
+  QThreadPool planner; // single thread, MEASURE runs one plan at a time
+};
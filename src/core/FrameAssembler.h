@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Stitches arbitrarily sized sample blocks into contiguous fixed-size frames,
+// optionally overlapping. Samples are never discarded: whatever does not
+// complete a frame stays pending for the next feed(), and changing the frame
+// size keeps it too. A running sample counter gives every frame its absolute
+// stream position.
+template <typename T> class FrameAssembler {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "FrameAssembler stores plain sample types only");
+
+public:
+  void setFrameSize(size_t n) {
+    n = std::max<size_t>(n, 1);
+    frameLen = n;
+    if (buf.size() < n)
+      buf.resize(n);
+  }
+  size_t frameSize() const { return frameLen; }
+
+  // Copies as many samples as fit into the current frame and returns how
+  // many were taken. Call again with the remainder once the frame is used.
+  size_t feed(const T *src, size_t n) {
+    const size_t take = fill < frameLen ? std::min(n, frameLen - fill) : 0;
+    if (take > 0) {
+      std::memcpy(buf.data() + fill, src, take * sizeof(T));
+      fill += take;
+      totalIn += take;
+    }
+    return take;
+  }
+
+  bool frameReady() const { return fill >= frameLen; }
+  const T *frame() const { return buf.data(); }
+  // Stream index of frame()[0]
+  uint64_t frameIndex() const { return totalOut; }
+  // Leading samples of frame() that an earlier, overlapping frame already
+  // delivered; the rest is new stream data.
+  size_t freshOffset() const { return std::min(carried, frameLen); }
+
+  // Releases the first `hop` samples of the current frame (the whole frame
+  // by default). A smaller hop keeps the tail for overlapping frames.
+  void consumeFrame(size_t hop = 0) {
+    if (fill < frameLen)
+      return;
+    if (hop == 0 || hop > frameLen)
+      hop = frameLen;
+    const size_t rest = fill - hop;
+    if (rest > 0)
+      std::memmove(buf.data(), buf.data() + hop, rest * sizeof(T));
+    fill = rest;
+    carried = std::max(carried, frameLen) - hop;
+    totalOut += hop;
+  }
+
+  size_t pending() const { return fill; }
+  // Total samples accepted so far (monotonic)
+  uint64_t samplesIn() const { return totalIn; }
+
+private:
+  std::vector<T> buf;
+  size_t frameLen{1};
+  size_t fill{0};
+  size_t carried{0}; // already-delivered samples at the front of buf
+  uint64_t totalIn{0};
+  uint64_t totalOut{0};
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size "last N samples" recorder for a single thread. Blocks are
+// copied in with at most one wrap split, and the most recent samples can be
+// read back in place as two spans (oldest first), so keeping a rolling
+// pre-trigger history costs one memcpy per block.
+template <typename T> class HistoryRing {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "HistoryRing stores plain sample types only");
+
+public:
+  // Up to two contiguous pieces, in stream order.
+  struct Spans {
+    const T *first{nullptr};
+    size_t firstLen{0};
+    const T *second{nullptr};
+    size_t secondLen{0};
+    size_t size() const { return firstLen + secondLen; }
+  };
+
+  // Allocates storage for `capacity` samples and forgets the history.
+  void reset(size_t capacity) {
+    buf.assign(capacity, T{});
+    clear();
+  }
+  void clear() {
+    head = 0;
+    filled = 0;
+  }
+  size_t capacity() const { return buf.size(); }
+  size_t size() const { return filled; }
+
+  void write(const T *src, size_t n) {
+    const size_t cap = buf.size();
+    if (cap == 0 || n == 0)
+      return;
+    if (n >= cap) {
+      // only the newest `cap` samples survive
+      std::memcpy(buf.data(), src + (n - cap), cap * sizeof(T));
+      head = 0;
+      filled = cap;
+      return;
+    }
+    const size_t firstPart = std::min(n, cap - head);
+    std::memcpy(buf.data() + head, src, firstPart * sizeof(T));
+    if (n > firstPart)
+      std::memcpy(buf.data(), src + firstPart, (n - firstPart) * sizeof(T));
+    head = (head + n) % cap;
+    filled = std::min(cap, filled + n);
+  }
+
+  // The newest min(n, size()) samples, oldest first.
+  Spans latest(size_t n) const {
+    Spans s;
+    const size_t cap = buf.size();
+    n = std::min(n, filled);
+    if (n == 0)
+      return s;
+    const size_t start = (head + cap - n) % cap;
+    s.first = buf.data() + start;
+    s.firstLen = std::min(n, cap - start);
+    if (s.firstLen < n) {
+      s.second = buf.data();
+      s.secondLen = n - s.firstLen;
+    }
+    return s;
+  }
+
+private:
+  std::vector<T> buf;
+  size_t head{0};   // next position to write
+  size_t filled{0}; // valid samples, at most capacity()
+};
@@ -0,0 +1,82 @@
+#include "NoiseFloorEstimator.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace {
+// most frames kept individually; longer windows are folded into this many
+constexpr int kMaxSlots = 64;
+// OrderedStatistic takes the cell at this quantile of the references
+constexpr double kOrderQuantile = 0.75;
+} // namespace
+
+void NoiseFloorEstimator::configure(int bins, int frames) {
+  N = std::max(1, bins);
+  frames = std::max(1, frames);
+  stride = (frames + kMaxSlots - 1) / kMaxSlots;
+  slotCount = std::max(1, (frames + stride - 1) / stride);
+  history.assign(size_t(slotCount) * size_t(N), 0.0f);
+  reset();
+}
+
+void NoiseFloorEstimator::reset() {
+  std::fill(history.begin(), history.end(), 0.0f);
+  sum.assign(size_t(N), 0.0);
+  pending.assign(size_t(N), 0.0);
+  pendingFrames = 0;
+  head = 0;
+  filled = 0;
+}
+
+void NoiseFloorEstimator::add(const float *power) {
+  for (int i = 0; i < N; ++i)
+    pending[size_t(i)] += double(power[i]);
+  if (++pendingFrames < stride)
+    return;
+  // swap the oldest slot out of the running sums and this one in
+  float *slot = history.data() + size_t(head) * size_t(N);
+  const bool full = filled == slotCount;
+  const double inv = 1.0 / double(stride);
+  for (int i = 0; i < N; ++i) {
+    const float v = float(pending[size_t(i)] * inv);
+    if (full)
+      sum[size_t(i)] -= double(slot[i]);
+    sum[size_t(i)] += double(v);
+    slot[i] = v;
+    pending[size_t(i)] = 0.0;
+  }
+  pendingFrames = 0;
+  head = (head + 1) % slotCount;
+  if (!full)
+    ++filled;
+}
+
+double NoiseFloorEstimator::floor(int lo, int hi, int guard, int reference,
+                                  Method method) {
+  if (filled == 0)
+    return 0.0;
+  lo = std::clamp(lo, 0, N - 1);
+  hi = std::clamp(hi, lo, N - 1);
+  guard = std::max(0, guard);
+  reference = std::max(1, reference);
+  cells.clear();
+  for (int b = std::max(0, lo - guard - reference); b < lo - guard; ++b)
+    cells.push_back(cell(b));
+  for (int b = hi + guard + 1; b < std::min(N, hi + guard + 1 + reference);
+       ++b)
+    cells.push_back(cell(b));
+  if (cells.empty()) {
+    for (int b = 0; b < N; ++b)
+      cells.push_back(cell(b));
+  }
+  if (method == OrderedStatistic) {
+    const auto k = cells.begin() + std::ptrdiff_t(std::min(
+                                       cells.size() - 1,
+                                       size_t(kOrderQuantile * cells.size())));
+    std::nth_element(cells.begin(), k, cells.end());
+    return *k;
+  }
+  double total = 0.0;
+  for (double c : cells)
+    total += c;
+  return total / double(cells.size());
+}
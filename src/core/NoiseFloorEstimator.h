@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Per-bin noise power over a sliding window of FFT frames, for CFAR
+// thresholds. Each bin keeps a running sum over the window, so a frame
+// costs one add and one subtract per bin whatever the window length. Long
+// windows fold `stride` frames into each slot to bound the memory.
+//
+// The floor under a group of cells is read from reference cells on both
+// sides of it, `guard` bins away so the signal's own skirts stay out:
+// their mean (cell averaging) or an upper order statistic (robust to
+// interferers among the references).
+class NoiseFloorEstimator {
+public:
+  enum Method { CellAveraging, OrderedStatistic };
+
+  // `bins` per frame, a window of `frames` frames. Clears the estimate.
+  void configure(int bins, int frames);
+  void reset();
+  int bins() const { return N; }
+  // frames that make up a full window
+  int windowFrames() const { return slotCount * stride; }
+  bool ready() const { return filled > 0; }
+
+  // Adds one frame of per-bin power, in display (FFT-shifted) order.
+  void add(const float *power);
+
+  // Mean noise power per bin around cells [lo, hi], from up to `reference`
+  // bins each side beyond `guard`. Falls back to the whole spectrum when
+  // the band leaves no reference cells. 0 until a frame has been added.
+  double floor(int lo, int hi, int guard, int reference, Method method);
+
+private:
+  double cell(int bin) const { return sum[size_t(bin)] / double(filled); }
+
+  int N{0};
+  int slotCount{1};
+  int stride{1};
+  std::vector<float> history; // slotCount x N, each slot the mean of `stride`
+  std::vector<double> sum;    // per-bin sum over the filled slots
+  std::vector<double> pending; // slot being accumulated
+  int pendingFrames{0};
+  int head{0};   // next slot to overwrite
+  int filled{0}; // valid slots
+  std::vector<double> cells; // reference cells (OrderedStatistic)
+};
@@ -0,0 +1,168 @@
+#include "Resampler.h"
+#include "Decimator.h"
+#include "DspKernels.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <tuple>
+
+namespace {
+// taps per phase are sized from the transition band and kept in this range
+constexpr int kMinTapsPerPhase = 16;
+constexpr int kMaxTapsPerPhase = 256;
+
+// Best rational approximation p/q of x with q <= maxDen (continued
+// fractions), returned as (p, q).
+std::pair<long long, long long> approximate(double x, long long maxDen) {
+  long long p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+  double v = x;
+  for (int i = 0; i < 64; ++i) {
+    const long long a = (long long)std::floor(v);
+    const long long p2 = a * p1 + p0, q2 = a * q1 + q0;
+    if (q2 > maxDen)
+      break;
+    p0 = p1;
+    q0 = q1;
+    p1 = p2;
+    q1 = q2;
+    const double frac = v - double(a);
+    if (frac < 1e-12)
+      break;
+    v = 1.0 / frac;
+  }
+  return {p1, q1};
+}
+} // namespace
+
+std::shared_ptr<const Resampler::Bank>
+Resampler::bankFor(int L, int M, double cutoff) {
+  // cutoff is normalised to the upsampled rate and quantised so that
+  // rates differing in float noise share a bank
+  const long long key = std::llround(cutoff * 1e9);
+  static QMutex mutex;
+  static std::map<std::tuple<int, int, long long>, std::shared_ptr<const Bank>>
+      cache;
+  QMutexLocker lock(&mutex);
+  auto it = cache.find({L, M, key});
+  if (it != cache.end())
+    return it->second;
+
+  // Rates are fractions of the upsampled rate. The pass band ends at
+  // cutoff and the stop band must start where the lower of the two rates
+  // would fold it back (rate - cutoff), so the response is centred on that
+  // rate's Nyquist and sized for the transition in between.
+  const double nyq = 0.5 / double(std::max(L, M));
+  const double transition = std::max(2.0 * (nyq - cutoff), 1e-4);
+  int perPhase = int(std::ceil(5.5 / transition / double(L)));
+  perPhase = std::clamp(perPhase, kMinTapsPerPhase, kMaxTapsPerPhase);
+
+  const int total = perPhase * L;
+  std::vector<float> h = Decimator::designLowpass(nyq, 1.0, total);
+  auto bank = std::make_shared<Bank>();
+  bank->taps = perPhase;
+  bank->dup.resize(size_t(total) * 2);
+  // phase p uses h[p + jL] against x[n - j]; store it reversed so the
+  // window x[n-K+1..n] is walked forward, with the L gain of zero stuffing
+  for (int p = 0; p < L; ++p) {
+    float *dst = bank->dup.data() + size_t(p) * size_t(perPhase) * 2;
+    for (int i = 0; i < perPhase; ++i) {
+      const int j = perPhase - 1 - i;
+      const float v = h[size_t(p + j * L)] * float(L);
+      dst[2 * i] = dst[2 * i + 1] = v;
+    }
+  }
+  cache.emplace(std::make_tuple(L, M, key), bank);
+  return bank;
+}
+
+void Resampler::configure(double inRate, double outRateHz, double cutoffHz) {
+  bank.reset();
+  L = M = 1;
+  outRate = inRate;
+  reset();
+  if (inRate <= 0.0 || outRateHz <= 0.0)
+    return;
+  // exact for the integral rates used in practice; anything else, or a
+  // ratio that needs too many phases, gets the closest M/L with bounded L
+  const long long a = std::llround(outRateHz), b = std::llround(inRate);
+  const bool integral = std::abs(double(a) - outRateHz) < 1e-6 &&
+                        std::abs(double(b) - inRate) < 1e-6;
+  long long num = 0, den = 0;
+  if (integral) {
+    const long long g = std::gcd(a, b);
+    num = a / g;
+    den = b / g;
+  }
+  if (!integral || num > kMaxPhases) {
+    const auto md = approximate(inRate / outRateHz, kMaxPhases);
+    num = md.second;
+    den = md.first;
+  }
+  if (num <= 0 || den <= 0)
+    return;
+  L = int(num);
+  M = int(den);
+  outRate = inRate * double(L) / double(M);
+  if (L == M) {
+    L = M = 1;
+    return;
+  }
+  const double upRate = inRate * double(L);
+  const double edge = 0.5 * std::min(inRate, outRate) * 0.9;
+  bank = bankFor(L, M, std::min(cutoffHz, edge) / upRate);
+}
+
+double Resampler::delay() const {
+  if (!bank)
+    return 0.0;
+  // output n ends its window at upsampled step n*M + (K-1)*L; the
+  // prototype's centre lies (K*L-1)/2 steps before that
+  const double K = double(bank->taps);
+  return (K - 1.0) - (K * double(L) - 1.0) / (2.0 * double(L));
+}
+
+void Resampler::reset() {
+  buf.clear();
+  pos = 0;
+  phase = 0;
+}
+
+void Resampler::process(const std::complex<float> *in, size_t n,
+                        std::vector<std::complex<float>> &out) {
+  if (!bank) {
+    out.insert(out.end(), in, in + n);
+    return;
+  }
+  buf.insert(buf.end(), in, in + n);
+  const size_t K = size_t(bank->taps);
+  const float *coeffs = bank->dup.data();
+  size_t p = pos;
+  int ph = phase;
+  while (p + K <= buf.size()) {
+    out.push_back(
+        dsp::firDot(buf.data() + p, coeffs + size_t(ph) * K * 2, int(K)));
+    // next output sits M upsampled steps later
+    ph += M;
+    p += size_t(ph / L);
+    ph %= L;
+  }
+  const size_t dropped = std::min(p, buf.size());
+  const size_t keep = buf.size() - dropped;
+  if (keep > 0 && dropped > 0)
+    std::memmove(buf.data(), buf.data() + dropped,
+                 keep * sizeof(std::complex<float>));
+  buf.resize(keep);
+  pos = p - dropped;
+  phase = ph;
+}
+
+void Resampler::flush(std::vector<std::complex<float>> &out) {
+  if (!bank)
+    return;
+  const std::vector<std::complex<float>> zeros(size_t(bank->taps) / 2 + 1);
+  process(zeros.data(), zeros.size(), out);
+}
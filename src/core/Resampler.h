@@ -0,0 +1,50 @@
+#pragma once
+#include <complex>
+#include <memory>
+#include <vector>
+
+// Streaming rational L/M polyphase resampler for complex samples. Output
+// rate is exactly inRate * L / M; the prototype low-pass runs at the
+// upsampled rate and is split into L phases, so each output costs one
+// short dot product with no zero stuffing. Filter banks are cached per
+// (L, M, cutoff) and shared between instances. Unconfigured, or with
+// L == M, samples pass straight through.
+class Resampler {
+public:
+  // Largest interpolation factor; rates that need more are approximated
+  // with the closest L/M below it (outputRate() reports what was used).
+  static constexpr int kMaxPhases = 1024;
+
+  // cutoffHz is the passband edge; it is capped below both Nyquist rates.
+  void configure(double inRate, double outRate, double cutoffHz);
+  void reset();
+
+  int up() const { return L; }
+  int down() const { return M; }
+  // Output n reads the tapsPerPhase() inputs from floor(n * down() / up()).
+  int tapsPerPhase() const { return bank ? bank->taps : 1; }
+  double outputRate() const { return outRate; }
+  // Output n is centred on input sample delay() + n * down() / up().
+  double delay() const;
+
+  void process(const std::complex<float> *in, size_t n,
+               std::vector<std::complex<float>> &out);
+  // Pushes zeros through so the samples still in the delay line come out.
+  void flush(std::vector<std::complex<float>> &out);
+
+private:
+  struct Bank {
+    int taps{0};            // per phase
+    std::vector<float> dup; // L phases of taps doubled for dsp::firDot,
+                            // each stored oldest-input first
+  };
+  static std::shared_ptr<const Bank> bankFor(int L, int M, double cutoff);
+
+  std::shared_ptr<const Bank> bank;
+  int L{1};
+  int M{1};
+  double outRate{0.0};
+  std::vector<std::complex<float>> buf; // unconsumed input, oldest first
+  size_t pos{0};                        // window start of the next output
+  int phase{0};                         // 0..L-1
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <QMap>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// One SDR as discovery found it, with the capabilities probed once when it
+// first appeared, so nobody has to open the device again to ask.
+struct SDRDeviceInfo {
+  QString driver; // "rtlsdr", "hackrf", ...
+  QString label;
+  QString serial;
+  QMap<QString, QString> args; // enumeration kwargs; make() opens this one
+  // RX channel 0, empty when the probe could not open the device
+  bool probed{false};
+  QVector<double> sampleRates;
+  QStringList gainNames; // gain elements, in the driver's order
+  double gainMinDb{0.0};
+  double gainMaxDb{0.0};
+  QStringList streamFormats;
+};
+Q_DECLARE_METATYPE(SDRDeviceInfo)
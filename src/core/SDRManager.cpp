@@ -1,25 +1,200 @@
-
 #include "SDRManager.h"
+#include <QDebug>
+#include <QMetaObject>
 #include <SoapySDR/Device.hpp>
+#include <SoapySDR/Formats.h>
+#include <map>
+#include <string>
+#ifdef DUALITY_HAVE_LIBUSB
+#include <libusb.h>
+#endif
+
+namespace {
+// without hotplug notifications the discovery thread polls this often
+constexpr unsigned long kPollMs = 3000;
+// a device that just arrived needs a moment before its driver sees it;
+// events within this window also collapse into one enumeration
+constexpr unsigned long kSettleMs = 300;
+constexpr unsigned long kWaitSliceMs = 100;
+
+QString str(const SoapySDR::Kwargs &args, const char *key) {
+  const auto it = args.find(key);
+  return it == args.end() ? QString() : QString::fromStdString(it->second);
+}
+
+// Identifies a device across enumerations.
+std::string keyOf(const SoapySDR::Kwargs &args) {
+  std::string key;
+  for (const auto &kv : args)
+    key += kv.first + "=" + kv.second + ",";
+  return key;
+}
+
+// Opens the device once and records what its RX side offers.
+SDRDeviceInfo describe(const SoapySDR::Kwargs &args) {
+  SDRDeviceInfo d;
+  d.driver = str(args, "driver");
+  d.label = str(args, "label");
+  d.serial = str(args, "serial");
+  for (const auto &kv : args)
+    d.args.insert(QString::fromStdString(kv.first),
+                  QString::fromStdString(kv.second));
+  SoapySDR::Device *dev = nullptr;
+  try {
+    dev = SoapySDR::Device::make(args);
+    for (double r : dev->listSampleRates(SOAPY_SDR_RX, 0))
+      d.sampleRates.push_back(r);
+    for (const std::string &g : dev->listGains(SOAPY_SDR_RX, 0))
+      d.gainNames.push_back(QString::fromStdString(g));
+    const SoapySDR::Range range = dev->getGainRange(SOAPY_SDR_RX, 0);
+    d.gainMinDb = range.minimum();
+    d.gainMaxDb = range.maximum();
+    for (const std::string &f : dev->getStreamFormats(SOAPY_SDR_RX, 0))
+      d.streamFormats.push_back(QString::fromStdString(f));
+    d.probed = true;
+  } catch (const std::exception &e) {
+    qWarning() << "[SDR] Probe failed for" << d.label << ":" << e.what();
+  } catch (...) {
+    qWarning() << "[SDR] Probe failed for" << d.label;
+  }
+  if (dev)
+    SoapySDR::Device::unmake(dev);
+  return d;
+}
+
+bool sameDevices(const QVector<SDRDeviceInfo> &a,
+                 const QVector<SDRDeviceInfo> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (int i = 0; i < a.size(); ++i) {
+    if (a[i].args != b[i].args || a[i].probed != b[i].probed)
+      return false;
+  }
+  return true;
+}
+
+#ifdef DUALITY_HAVE_LIBUSB
+int LIBUSB_CALL onHotplug(libusb_context *, libusb_device *,
+                          libusb_hotplug_event, void *changed) {
+  static_cast<std::atomic<bool> *>(changed)->store(true,
+                                                   std::memory_order_release);
+  return 0; // stay registered
+}
+#endif
+} // namespace
 
 SDRManager::SDRManager(QObject *parent)
-    : QObject(parent), rtlFound(false), hackrfFound(false) {}
+    : QObject(parent), rtlFound(false), hackrfFound(false) {
+  qRegisterMetaType<SDRDeviceInfo>("SDRDeviceInfo");
+}
+
+SDRManager::~SDRManager() { stop(); }
 
 bool SDRManager::hasRTLSDR() const { return rtlFound; }
 bool SDRManager::hasHackRF() const { return hackrfFound; }
 
-void SDRManager::pollDevices() {
-  auto results = SoapySDR::Device::enumerate();
-  bool rtl = false, hack = false;
+void SDRManager::start() {
+  if (discovery)
+    return;
+  stopping.store(false, std::memory_order_release);
+  discovery = QThread::create([this]() { discoveryLoop(); });
+  discovery->setObjectName("SDRDiscovery");
+  discovery->start(QThread::LowPriority);
+}
+
+void SDRManager::stop() {
+  if (!discovery)
+    return;
+  stopping.store(true, std::memory_order_release);
+  discovery->wait();
+  delete discovery;
+  discovery = nullptr;
+}
+
+// Discovery thread. Probed capabilities are cached by enumeration kwargs
+// for as long as the device stays attached.
+void SDRManager::discoveryLoop() {
+  std::map<std::string, SDRDeviceInfo> known;
+  std::atomic<bool> changed{true}; // enumerate once right away
+  bool hotplug = false;
+#ifdef DUALITY_HAVE_LIBUSB
+  libusb_context *usb = nullptr;
+  libusb_hotplug_callback_handle handle = 0;
+  if (libusb_init(&usb) == 0 &&
+      libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG) != 0) {
+    hotplug = libusb_hotplug_register_callback(
+                  usb,
+                  libusb_hotplug_event(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED |
+                                       LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+                  LIBUSB_HOTPLUG_NO_FLAGS, LIBUSB_HOTPLUG_MATCH_ANY,
+                  LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+                  onHotplug, &changed, &handle) == LIBUSB_SUCCESS;
+  }
+#endif
+  qInfo() << "[SDR] Discovery thread start,"
+          << (hotplug ? "USB hotplug events" : "polling");
 
-  for (auto &r : results) {
-    if (r.find("driver") == r.end())
+  unsigned long idleMs = 0;
+  while (!stopping.load(std::memory_order_acquire)) {
+    if (changed.exchange(false, std::memory_order_acq_rel)) {
+      idleMs = 0;
+      std::map<std::string, SDRDeviceInfo> present;
+      QVector<SDRDeviceInfo> list;
+      for (const SoapySDR::Kwargs &args : SoapySDR::Device::enumerate()) {
+        const std::string key = keyOf(args);
+        auto it = known.find(key);
+        SDRDeviceInfo d =
+            it != known.end() ? std::move(it->second) : describe(args);
+        if (it == known.end())
+          qInfo() << "[SDR] Found" << d.driver << d.label
+                  << "rates=" << d.sampleRates.size()
+                  << "gains=" << d.gainNames.join(",");
+        list.push_back(d);
+        present.emplace(key, std::move(d));
+      }
+      // devices that left are forgotten, so a replug probes again
+      known.swap(present);
+      QMetaObject::invokeMethod(
+          this, [this, list]() { publish(list); }, Qt::QueuedConnection);
+      continue;
+    }
+#ifdef DUALITY_HAVE_LIBUSB
+    if (hotplug) {
+      timeval tv{0, long(kWaitSliceMs * 1000)};
+      libusb_handle_events_timeout_completed(usb, &tv, nullptr);
+      if (changed.load(std::memory_order_acquire))
+        QThread::msleep(kSettleMs);
       continue;
-    if (r.at("driver") == "rtlsdr")
+    }
+#endif
+    QThread::msleep(kWaitSliceMs);
+    idleMs += kWaitSliceMs;
+    if (idleMs >= kPollMs)
+      changed.store(true, std::memory_order_release);
+  }
+
+#ifdef DUALITY_HAVE_LIBUSB
+  if (hotplug)
+    libusb_hotplug_deregister_callback(usb, handle);
+  if (usb)
+    libusb_exit(usb);
+#endif
+}
+
+void SDRManager::publish(const QVector<SDRDeviceInfo> &devices) {
+  // the first result always goes out, later ones only when they differ
+  if (published && sameDevices(devices, found))
+    return;
+  published = true;
+  found = devices;
+  bool rtl = false, hack = false;
+  for (const SDRDeviceInfo &d : found) {
+    if (d.driver == "rtlsdr")
       rtl = true;
-    if (r.at("driver") == "hackrf")
+    if (d.driver == "hackrf")
       hack = true;
   }
+  emit devicesChanged(found);
 
   if (rtl != rtlFound || hack != hackrfFound) {
     rtlFound = rtl;
@@ -1,20 +1,41 @@
-
 #pragma once
+#include "SDRDeviceInfo.h"
 #include <QObject>
-#include <SoapySDR/Device.hpp>
+#include <QThread>
+#include <QVector>
+#include <atomic>
 
+// Finds the attached SDRs off the GUI thread. start() enumerates once
+// right away on a discovery thread, which then sleeps until libusb reports
+// a USB device arriving or leaving (or, built without libusb hotplug,
+// until a slow poll) and enumerates again. Devices are probed for their
+// capabilities once when they first show up; results arrive on the
+// manager's thread.
 class SDRManager : public QObject {
   Q_OBJECT
 public:
   explicit SDRManager(QObject *parent = nullptr);
+  ~SDRManager() override;
+
+  void start();
+  void stop();
   bool hasRTLSDR() const;
   bool hasHackRF() const;
-  void pollDevices();
+  QVector<SDRDeviceInfo> devices() const { return found; }
 
 signals:
   void devicesUpdated(bool rtlFound, bool hackrfFound);
+  // every completed enumeration that changed the device list
+  void devicesChanged(const QVector<SDRDeviceInfo> &devices);
 
 private:
+  void discoveryLoop();
+  void publish(const QVector<SDRDeviceInfo> &devices);
+
   bool rtlFound;
   bool hackrfFound;
+  QVector<SDRDeviceInfo> found;
+  bool published{false}; // a first enumeration has been reported
+  QThread *discovery{nullptr};
+  std::atomic<bool> stopping{false};
 };
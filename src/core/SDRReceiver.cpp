@@ -1,622 +1,1883 @@
 
 #include "SDRReceiver.h"
-#include <QCoreApplication>
+#include "CaptureJob.h"
+#include "ChannelPowerDetector.h"
+#include "Channelizer.h"
+#include "CommandQueue.h"
+#include "CpuAffinity.h"
+#include "Decimator.h"
+#include "DiskWriter.h"
+#include "DspKernels.h"
+#include "FftEngine.h"
+#include "FftPlanCache.h"
+#include "FrameAssembler.h"
+#include "Resampler.h"
+#include "HistoryRing.h"
+#include "NoiseFloorEstimator.h"
+#include "SampleRing.h"
+#include "SigMF.h"
+#include "SpectrumAggregator.h"
+#include "SpectrumStitcher.h"
+#include "TriggerGate.h"
+#include "TripleBuffer.h"
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QMetaType>
+#include <QThreadPool>
 #include <SoapySDR/Device.hpp>
+#include <SoapySDR/Errors.h>
 #include <SoapySDR/Formats.h>
 #include <algorithm>
 #include <atomic>
 #include <cmath>
 #include <complex>
+#include <deque>
 #include <fftw3.h>
+#include <limits>
 #include <math.h>
+#include <memory>
 #include <vector>
 
+namespace {
+// trigger detectors, numbered as SDRReceiver::setDetectorMode takes them
+enum Detector {
+  kDetectorAveraged = 0,     // FFT bins, averaged over avgTauSeconds
+  kDetectorPeak = 1,         // FFT bins, instantaneous
+  kDetectorChannelPower = 2, // time-domain power (ChannelPowerDetector)
+};
+
+// where the trigger threshold comes from, numbered as
+// SDRReceiver::setThresholdMode takes them
+enum ThresholdSource {
+  kThresholdFixed = 0,  // triggerThresholdDb as set
+  kThresholdCaCfar = 1, // margin above the mean of the reference cells
+  kThresholdOsCfar = 2, // margin above their upper order statistic
+};
+
+// Ties a stream sample index to UTC. The reader publishes one for every
+// block that carries a device timestamp, and one from the host clock for
+// the first block if the device has none; later indices are placed by
+// counting samples from the newest anchor.
+struct ClockAnchor {
+  uint64_t index{0};
+  qint64 utcNs{0};
+  bool device{false};
+};
+
+// One watched channel of the ChannelPlan: its own pre-trigger history,
+// dwell / post-roll gate and capture, all at the channel rate and indexed
+// in channel samples.
+struct ChannelTrigger {
+  ChannelWatch watch;
+  HistoryRing<std::complex<float>> history;
+  TriggerGate gate;
+  bool capturing{false};
+  uint64_t captureFirst{0}; // channel sample index of capture[0]
+  std::vector<std::complex<float>> capture;
+  // power reading being accumulated
+  double accPower{0.0};
+  int accCount{0};
+  uint64_t accFirst{0};
+};
+
+// Reader thread totals, read by the DSP thread for StreamStats.
+struct ReaderCounters {
+  std::atomic<uint64_t> overflows{0};
+  std::atomic<uint64_t> timeouts{0};
+  std::atomic<uint64_t> timeJumps{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<uint64_t> zeroFilled{0};
+  std::atomic<uint64_t> gaps{0};
+  std::atomic<uint64_t> settleDiscarded{0};
+};
+
+// GUI -> worker control message. Everything the UI can change while the
+// stream runs goes through one of these instead of a queued invocation.
+struct RxCommand {
+  enum Kind {
+    None,
+    Tune,          // a = frequency (Hz), b = sample rate
+    Gain,          // a = dB
+    Threshold,     // a = dB
+    ThresholdMode, // n = ThresholdSource
+    CfarMargin,    // a = dB
+    CaptureSpan,   // a = half-span (Hz)
+    CaptureRate,   // a = output rate (Hz), 0 = rate / D
+    DetectorMode,  // n = Detector
+    Dwell,         // a = seconds
+    AvgTau,        // a = seconds
+    Arm,           // a = pre seconds, b = post seconds, n = generation
+    Cancel,
+    BeginCapture, // path
+    EndCapture,
+    FftSize,     // n = points
+    FftOverlap,  // a = fraction
+    DisplayRate, // a = fps
+    DisplayMode, // n = SpectrumAggregator::Mode
+    Channels,    // plan
+    Device,      // device, n = pipeline index
+    Cores,       // cores
+    Sweep,       // a = start Hz, b = stop Hz; a >= b stops
+    Stop,
+  };
+  RxCommand() = default;
+  RxCommand(Kind k, double a = 0.0, double b = 0.0) : kind(k), a(a), b(b) {}
+  RxCommand(Kind k, int n) : kind(k), n(n) {}
+
+  Kind kind{None};
+  double a{0.0};
+  double b{0.0};
+  int n{0};
+  QString path;
+  std::shared_ptr<const ChannelPlan> plan;
+  std::shared_ptr<const SDRDeviceInfo> device;
+  std::shared_ptr<const std::vector<int>> cores;
+};
+} // namespace
+
 class SDRReceiver::Worker : public QObject {
   Q_OBJECT
 public:
-  Worker() = default;
-  ~Worker() override { closeDevice(); }
+  // `cores`: CPUs this pipeline may use, the reader on the first and the
+  // DSP and FFT threads on the rest; empty leaves scheduling to the OS.
+  // `captureClaim` is shared by all pipelines, see claimCapture().
+  Worker(TripleBuffer<std::vector<float>> *mailbox,
+         std::atomic<bool> *mailboxPending, std::atomic<int> *captureClaim,
+         std::vector<int> cores)
+      : mailbox(mailbox), mailboxPending(mailboxPending),
+        captureClaim(captureClaim), cores(std::move(cores)) {
+    monotonic.start();
+    // one capture at a time keeps the disk writes sequential
+    finalizePool.setMaxThreadCount(1);
+    finalizePool.setObjectName("CaptureFinalize");
+  }
+  ~Worker() override {
+    closeDevice();
+    // let a running finalize finish, drop queued ones
+    finalizePool.clear();
+    finalizePool.waitForDone();
+  }
 
-public slots:
-  void configure(double freqMHz, double sampleRate) {
-    // Route to thread-safe immediate setter
-    configureImmediate(freqMHz, sampleRate);
-  }
-  void setGain(double gDb) {
-    // Called in worker thread via queued connection
-    pendingGain.store(gDb, std::memory_order_release);
-    gainDb = gDb;
-    if (dev) {
-      // Ensure manual mode and apply immediately
-      try {
-        dev->setGainMode(SOAPY_SDR_RX, 0, false);
-        // Disable any digital/tuner AGC settings some RTL stacks expose
-        try {
-          dev->writeSetting("rtl_agc", "false");
-        } catch (...) {
-        }
-        try {
-          dev->writeSetting("tuner_agc", "false");
-        } catch (...) {
-        }
-        // Try specific element names commonly used by RTL-SDR
-        try {
-          dev->setGain(SOAPY_SDR_RX, 0, "LNA", gainDb);
-        } catch (...) {
-        }
-        try {
-          dev->setGain(SOAPY_SDR_RX, 0, "TUNER", gainDb);
-        } catch (...) {
-        }
-        // Fallback to aggregate
-        try {
-          dev->setGain(SOAPY_SDR_RX, 0, gainDb);
-        } catch (...) {
-        }
-      } catch (...) {
-      }
-    }
-    reconfigureRequested.store(true, std::memory_order_release);
+  // Called from the GUI thread only (single producer). The worker applies
+  // commands between frames, in order, all pending ones in one go.
+  bool post(RxCommand cmd) {
+    if (commands.push(std::move(cmd)))
+      return true;
+    qWarning() << "[RX] Control queue full, command dropped";
+    return false;
   }
 
+private:
   void setThresholdDb(double db) {
-    triggerThresholdDb.store(db, std::memory_order_release);
+    triggerThresholdDb = db;
     qInfo() << "[RX] Set trigger threshold (dB)=" << db;
   }
 
+  void setThresholdMode(int mode) {
+    static const char *const names[] = {"Fixed", "CA-CFAR", "OS-CFAR"};
+    thresholdMode =
+        std::clamp(mode, int(kThresholdFixed), int(kThresholdOsCfar));
+    qInfo() << "[RX] Set threshold mode ->" << names[thresholdMode];
+  }
+
   void setCaptureSpan(double halfSpanHz) {
     if (halfSpanHz < 0.0)
       halfSpanHz = 0.0;
-    captureSpanHalfHz.store(halfSpanHz, std::memory_order_release);
+    captureSpanHalfHz = halfSpanHz;
     qInfo() << "[RX] Set capture span half-width (Hz)=" << halfSpanHz;
+    configureChannelDetector();
+  }
+
+  void setCaptureRate(double hz) {
+    captureRateHz = std::max(0.0, hz);
+    qInfo() << "[RX] Set capture output rate (Hz)=" << captureRateHz;
   }
 
-  void setDetectorModeSlot(int mode) {
-    int m = (mode == 1) ? 1 : 0;
-    detectorMode.store(m, std::memory_order_release);
-    qInfo() << "[RX] Set detector mode ->" << (m == 0 ? "Averaged" : "Peak");
+  void setDetectorMode(int mode) {
+    static const char *const names[] = {"Averaged", "Peak", "Channel power"};
+    detectorMode = std::clamp(mode, int(kDetectorAveraged),
+                              int(kDetectorChannelPower));
+    qInfo() << "[RX] Set detector mode ->" << names[detectorMode];
   }
 
-  void setDwellSecondsSlot(double s) {
+  void setDwellSeconds(double s) {
     if (s < 0.0)
       s = 0.0;
     dwellSeconds = s;
     qInfo() << "[RX] Set dwell seconds ->" << s;
+    ensureHistory(); // the pre-roll is counted from the start of the dwell
   }
 
-  void setAvgTauSecondsSlot(double s) {
+  void setAvgTauSeconds(double s) {
     if (s < 0.0)
       s = 0.0;
     avgTauSeconds = s;
     qInfo() << "[RX] Set avg tau seconds ->" << s;
   }
 
-  void armCapture(double preSec, double postSec) {
+  void armCapture(double preSec, double postSec, int generation) {
     qInfo() << "[RX] Arm capture pre(s)=" << preSec << "post(s)=" << postSec
             << "rate=" << rate << "freq(MHz)=" << freqHz / 1e6;
-    armed.store(true, std::memory_order_release);
-    inCapture.store(false, std::memory_order_release);
+    armed = true;
+    armGeneration = generation;
+    inCapture = false;
+    captureReleased = false;
     preSeconds = std::max(0.0, preSec);
     postSeconds = std::max(0.0, postSec);
-    belowSamples = 0;
+    gate.reset();
     totalSamplesSinceArm = 0;
-    preHead = 0;
     centerAvgLin = 0.0;
-    aboveStreakSamples = 0;
     peakLogAccum = 0;
     // begin visible on-disk spooling so user sees a file immediately
     // we will delete this temporary once the trimmed capture is written
-    if (spoolFile.isOpen())
-      spoolFile.close();
+    if (spoolHandle >= 0)
+      writer.close(spoolHandle, true);
+    spoolHandle = -1;
     QDir().mkpath("captures");
     armStartTime = QDateTime::currentDateTimeUtc();
     QString ts = armStartTime.toString("yyyyMMdd_HHmmss");
     double rxMHz = freqHz / 1e6;
-    spoolPath = QString("captures/in_progress_%1_RX%2.cf32.part")
+    spoolPath = QString("captures/in_progress_%1_RX%2.cs8.part")
                     .arg(ts)
                     .arg(rxMHz, 0, 'f', 3);
-    spoolFile.setFileName(spoolPath);
-    if (!spoolFile.open(QIODevice::WriteOnly)) {
+    // the spool is only feedback, so it drops rather than stall the stream
+    spoolHandle = writer.open(spoolPath, DiskWriter::Drop);
+    if (spoolHandle < 0) {
       // if we cannot open, just proceed without spooling
       spoolPath.clear();
     }
     if (!spoolPath.isEmpty())
       qInfo() << "[RX] Spooling to" << spoolPath;
-    // configure prebuffer capacity based on current sample rate
-    preBufferCap = static_cast<uint64_t>(std::llround(rate * preSeconds));
-    preBuffer.clear();
-    if (preBufferCap > 0) {
-      preBuffer.resize(static_cast<size_t>(preBufferCap));
-      preHead = 0;
-      preFilled = 0;
-    }
+    // the history ring is already recording; only grow it if this arm asks
+    // for more pre-roll than it holds
+    ensureHistory();
+    configureChannelDetector();
   }
 
   void cancelCapture() {
     qInfo() << "[RX] Cancel capture";
-    armed.store(false, std::memory_order_release);
-    inCapture.store(false, std::memory_order_release);
-    belowSamples = 0;
+    // also abandon any capture still being finalized
+    finalizeGeneration.fetch_add(1, std::memory_order_acq_rel);
+    armed = false;
+    inCapture = false;
+    captureReleased = false;
+    gate.reset();
     totalSamplesSinceArm = 0;
-    preHead = 0;
-    preFilled = 0;
-    preBuffer.clear();
     captureBuffer.clear();
     centerAvgLin = 0.0;
-    aboveStreakSamples = 0;
     peakLogAccum = 0;
-    if (spoolFile.isOpen()) {
-      spoolFile.close();
-      if (!spoolPath.isEmpty())
-        QFile::remove(spoolPath);
+    if (spoolHandle >= 0) {
+      writer.close(spoolHandle, true);
+      spoolHandle = -1;
       spoolPath.clear();
     }
   }
 
+public slots:
   void startWork() {
     running = true;
-    qInfo() << "[RX] Worker thread start";
-    activeFftSize =
-        std::clamp(requestedFftSize.load(std::memory_order_acquire), 512, 8192);
-    std::vector<std::complex<float>> buff(activeFftSize);
-    std::vector<float> window(activeFftSize, 1.0f);
-    std::vector<float> prevAmp(activeFftSize, 0.0f);
-    float coherentGain = 1.0f; // sum(w)/N for amplitude normalization
-    auto buildHann = [&](int N) {
-      window.resize(N);
-      double sumW = 0.0;
-      for (int i = 0; i < N; ++i) {
-        float w =
-            0.5f *
-            (1.0f - std::cos(2.0f * float(M_PI) * float(i) / float(N - 1)));
-        window[i] = w;
-        sumW += w;
-      }
-      coherentGain = float(sumW / double(N));
-      prevAmp.assign(N, 0.0f);
-    };
+    qInfo() << "[RX] Worker thread start, DSP kernels:" << dsp::isaName();
+    applyCores();
+    // start-up settings were posted before the thread started
+    drainCommands();
+    activeFftSize = std::clamp(requestedFftSize, 512, 8192);
+    assembler.setFrameSize(size_t(activeFftSize));
     buildHann(activeFftSize);
-    const float alpha = 0.4f; // smoothing factor, lower = more smoothing
+    std::vector<dsp::Cs8> chunk(kReadChunk);
+    // plan the sizes the UI can switch between so a change costs nothing
+    const std::vector<int> sizes{512, 1024, 2048, 4096, 8192};
+    FftPlanCache::instance().prewarm(sizes, FFTW_FORWARD);
+    FftPlanCache::instance().prewarm(sizes, FFTW_FORWARD, 4);
+    ensureFFTW(activeFftSize);
 
     while (running) {
-      // Allow queued invocations (arm/cancel/threshold/span/mode/etc.)
-      // to be processed while this long-running loop is active.
-      QCoreApplication::processEvents();
+      // Control changes take effect here, between frames
+      drainCommands();
       if (QThread::currentThread()->isInterruptionRequested())
         running = false;
-      if (!dev)
-        openDevice(); // lazy open
-      if (!dev) {
-        QThread::msleep(200);
+      if (!superviseStream()) {
+        // still taking commands while the device is down
+        QThread::msleep(10);
         continue;
       }
+      logRingStats();
 
-      int desired = std::clamp(requestedFftSize.load(std::memory_order_acquire),
-                               512, 8192);
+      int desired = std::clamp(requestedFftSize, 512, 8192);
       if (desired != activeFftSize) {
+        // pending samples carry over into the first frame of the new size
+        flushBatch();
         activeFftSize = desired;
-        buff.assign(activeFftSize, std::complex<float>{});
+        assembler.setFrameSize(size_t(activeFftSize));
         ensureFFTW(activeFftSize);
         buildHann(activeFftSize);
       }
 
-      void *buffs[] = {buff.data()};
-
-      // small timeout to stay responsive on stop/capture toggles
-      int flags;
-      long long timeNs;
-      int ret =
-          dev->readStream(stream, buffs, activeFftSize, flags, timeNs, 10'000);
-      if (ret <= 0)
+      // Samples arrive from the reader thread in whatever block sizes the
+      // driver produced; wait briefly (to stay responsive on stop/capture
+      // toggles) when nothing is queued.
+      const size_t got = sampleRing.read(chunk.data(), chunk.size());
+      if (got == 0) {
+        QThread::usleep(500);
         continue;
-      if (ret != activeFftSize)
+      }
+      lastSamples.restart();
+      reportRetune();
+      ringLogAccum += static_cast<uint64_t>(got);
+      drainGaps();
+      reportStreamStats(got);
+      // stitch partial blocks into contiguous (optionally overlapping) FFT
+      // frames; every sample is fresh in exactly one frame so captures see
+      // a gap-free stream
+      const double overlap = std::clamp(fftOverlap, 0.0, 0.9);
+      const size_t hop = size_t(std::max(
+          1, activeFftSize - int(std::lround(activeFftSize * overlap))));
+      size_t used = 0;
+      while (used < got) {
+        used += assembler.feed(chunk.data() + used, got - used);
+        if (!assembler.frameReady())
+          break;
+        stageFrame();
+        assembler.consumeFrame(hop);
+        if (batchCount == fft.capacity())
+          flushBatch();
+      }
+      // Batch up frames only while catching up on a backlog; once the
+      // reader has nothing more queued, process what we have right away.
+      if (sampleRing.available() < hop)
+        flushBatch();
+    }
+    closeDevice();
+  }
+
+private:
+  // Applies every command posted since the last call. Frames already staged
+  // for the FFT are finished with the old settings first, so a change
+  // takes effect from the first frame read after it was posted; several
+  // changes posted together land together.
+  void drainCommands() {
+    if (commands.empty())
+      return;
+    flushBatch();
+    bool retune = false;
+    bool reopen = false;
+    bool repin = false;
+    RxCommand cmd;
+    while (commands.pop(cmd)) {
+      switch (cmd.kind) {
+      case RxCommand::Tune:
+        // while sweeping the LO belongs to the sweep; this is where it
+        // goes back to
+        (sweeping ? sweepHomeHz : freqHz) = cmd.a;
+        rate = cmd.b;
+        retune = true;
+        break;
+      case RxCommand::Gain:
+        gainDb = cmd.a;
+        retune = true;
+        break;
+      case RxCommand::Threshold:
+        setThresholdDb(cmd.a);
+        break;
+      case RxCommand::ThresholdMode:
+        setThresholdMode(cmd.n);
+        break;
+      case RxCommand::CfarMargin:
+        cfarMarginDb = std::max(0.0, cmd.a);
+        qInfo() << "[RX] Set CFAR margin (dB)=" << cfarMarginDb;
+        break;
+      case RxCommand::CaptureSpan:
+        setCaptureSpan(cmd.a);
+        break;
+      case RxCommand::CaptureRate:
+        setCaptureRate(cmd.a);
+        break;
+      case RxCommand::DetectorMode:
+        setDetectorMode(cmd.n);
+        break;
+      case RxCommand::Dwell:
+        setDwellSeconds(cmd.a);
+        break;
+      case RxCommand::AvgTau:
+        setAvgTauSeconds(cmd.a);
+        break;
+      case RxCommand::Arm:
+        armCapture(cmd.a, cmd.b, cmd.n);
+        break;
+      case RxCommand::Cancel:
+        cancelCapture();
+        break;
+      case RxCommand::BeginCapture:
+        beginCapture(cmd.path);
+        break;
+      case RxCommand::EndCapture:
+        endCapture();
+        break;
+      case RxCommand::FftSize:
+        updateFftSize(cmd.n);
+        break;
+      case RxCommand::FftOverlap:
+        updateFftOverlap(cmd.a);
+        break;
+      case RxCommand::DisplayRate:
+        updateDisplayRate(cmd.a);
+        break;
+      case RxCommand::DisplayMode:
+        updateDisplayMode(cmd.n);
+        break;
+      case RxCommand::Channels:
+        if (cmd.plan)
+          setChannelPlan(*cmd.plan);
+        break;
+      case RxCommand::Device:
+        // a stream opened before discovery reported is on whichever
+        // RTL-SDR came first, not necessarily this one
+        if (cmd.device && cmd.device->args != deviceInfo.args)
+          reopen = dev != nullptr;
+        if (cmd.device)
+          deviceInfo = *cmd.device;
+        pipelineIndex = cmd.n;
+        break;
+      case RxCommand::Cores:
+        if (cmd.cores && *cmd.cores != cores) {
+          cores = *cmd.cores;
+          repin = true;
+        }
+        break;
+      case RxCommand::Sweep:
+        if (cmd.a < cmd.b)
+          startSweep(cmd.a, cmd.b);
+        else
+          stopSweep();
+        break;
+      case RxCommand::Stop:
+        running = false;
+        break;
+      case RxCommand::None:
+        break;
+      }
+    }
+    // several tuning changes in one drain cost a single retune
+    if (retune)
+      applyTuning();
+    if (repin)
+      applyCores();
+    if (reopen) {
+      // the watchdog opens the assigned device on its next pass
+      qInfo() << "[RX] Reopening on" << deviceInfo.label << deviceInfo.serial;
+      closeDevice();
+      noteGap({assembler.samplesIn(), 0, StreamGap::Restart});
+    }
+  }
+
+  void beginCapture(const QString &path) {
+    if (fileHandle >= 0)
+      writer.close(fileHandle);
+    fileHandle = writer.open(path, DiskWriter::Drop);
+    if (fileHandle < 0) {
+      capturing = false;
+      return;
+    }
+    capturing = true;
+    manualInfo = CaptureResult();
+    manualInfo.filePath = path;
+    manualInfo.datatype = "ci8";
+    manualGaps.clear();
+    manualInfo.centerHz = freqHz;
+    manualInfo.sampleRate = rate;
+    fillCaptureInfo(manualInfo);
+    qInfo() << "[RX] Manual capture BEGIN ->" << path;
+  }
+  void endCapture() {
+    capturing = false;
+    manualInfo.gaps = gapsInFile(manualGaps, manualInfo.startSample, 1.0,
+                                 manualInfo.samples);
+    // stream gaps and samples the disk writer dropped are both zeros in
+    // the file, and both are annotated
+    if (fileHandle >= 0)
+      writer.close(fileHandle, false, [info = manualInfo](bool ok) {
+        if (!ok)
+          qWarning() << "[RX] Manual capture incomplete (write errors)";
+        else
+          sigmf::writeMeta(info);
+      });
+    fileHandle = -1;
+    qInfo() << "[RX] Manual capture END";
+  }
+  void updateFftSize(int size) {
+    int clamped = std::clamp(size, 512, 8192);
+    requestedFftSize = clamped;
+  }
+  void updateFftOverlap(double fraction) {
+    fftOverlap = std::clamp(fraction, 0.0, 0.9);
+  }
+  void updateDisplayRate(double fps) {
+    displayRateHz = std::clamp(fps, 0.1, 240.0);
+  }
+  void updateDisplayMode(int mode) {
+    displayMode = mode == SpectrumAggregator::PowerAverage
+                      ? SpectrumAggregator::PowerAverage
+                      : SpectrumAggregator::MaxHold;
+  }
+
+  // Windows the assembler's current frame into the next FFT batch slot and
+  // keeps its fresh (non-overlapped) samples for the capture path.
+  void stageFrame() {
+    const dsp::Cs8 *frame = assembler.frame();
+    // the only float copy of the frame is this FFT input
+    dsp::cs8ToComplex(frame, kIqScale, frameIq.data(), activeFftSize);
+    dsp::windowToComplex(frameIq.data(), window.data(),
+                         fft.input(batchCount)[0], activeFftSize);
+    const size_t freshOff = assembler.freshOffset();
+    const size_t slot = size_t(batchCount) * size_t(activeFftSize);
+    std::copy(frame + freshOff, frame + activeFftSize,
+              batchFresh.begin() + slot);
+    batchFreshLen[size_t(batchCount)] = activeFftSize - int(freshOff);
+    batchFreshIndex[size_t(batchCount)] = assembler.frameIndex() + freshOff;
+    ++batchCount;
+  }
+  // Transforms all staged frames in one batched call, then runs the
+  // per-frame logic in stream order.
+  void flushBatch() {
+    if (batchCount == 0)
+      return;
+    fft.execute(batchCount);
+    for (int k = 0; k < batchCount; ++k) {
+      if (sweeping) {
+        sweepFrame(fft.output(k), batchFreshIndex[size_t(k)] +
+                                      uint64_t(batchFreshLen[size_t(k)]));
         continue;
+      }
+      const size_t slot = size_t(k) * size_t(activeFftSize);
+      processFrame(fft.output(k), batchFresh.data() + slot,
+                   batchFreshLen[size_t(k)], batchFreshIndex[size_t(k)]);
+    }
+    batchCount = 0;
+  }
+  // Spectrum emit, trigger logic and capture writes for one transformed
+  // frame; `buff` holds the `ret` samples the frame added to the stream.
+  // `first` is the stream index of buff[0].
+  void processFrame(const fftwf_complex *out, const dsp::Cs8 *buff, int ret,
+                    uint64_t first) {
+    streamIndex = first;
+    const float invN = 1.0f / float(activeFftSize);
+    const float ampScale =
+        invN / std::max(coherentGain,
+                        1e-9f); // normalize FFT and window coherent gain
+    // amplitude relative to full-scale; the display gets the unsmoothed
+    // value so max-hold keeps single-frame bursts
+    dsp::magnitude(out[0], ampScale, frameAmp.data(), activeFftSize);
+    aggregator.setMode(SpectrumAggregator::Mode(displayMode));
+    aggregator.add(frameAmp.data(), activeFftSize);
+    // detector input: smoothed in amplitude domain and clamped to [0,1.5]
+    // to avoid crazy spikes from driver
+    dsp::smooth(frameAmp.data(), prevAmp.data(), alpha, 1.5f, amps.data(),
+                activeFftSize);
+    // FFT shift: arrange bins as [-Fs/2 .. +Fs/2)
+    int half = activeFftSize / 2;
+    for (int i = 0; i < activeFftSize; ++i)
+      ampsShift[i] = amps[(i + half) % activeFftSize];
+    updateNoiseFloor(ret);
 
-      // FFT
-      ensureFFTW(activeFftSize);
-      for (int i = 0; i < activeFftSize; ++i) {
-        float w = window[i];
-        in[i][0] = buff[i].real() * w;
-        in[i][1] = buff[i].imag() * w;
-      }
-      fftwf_execute(plan);
-
-      QVector<float> amps(activeFftSize);
-      const float invN = 1.0f / float(activeFftSize);
-      const float ampScale =
-          invN / std::max(coherentGain,
-                          1e-9f); // normalize FFT and window coherent gain
-      for (int i = 0; i < activeFftSize; ++i) {
-        float re = out[i][0] * ampScale;
-        float im = out[i][1] * ampScale;
-        float a =
-            std::sqrt(re * re + im * im); // amplitude relative to full-scale
-        // temporal smoothing in amplitude domain
-        float s = alpha * a + (1.0f - alpha) * prevAmp[i];
-        prevAmp[i] = s;
-        // clamp to [0,1.5] to avoid crazy spikes from driver; UI will dB-map
-        amps[i] = std::min(s, 1.5f);
-      }
-      // FFT shift: arrange bins as [-Fs/2 .. +Fs/2)
-      QVector<float> ampsShift(activeFftSize);
-      int half = activeFftSize / 2;
+    // Only one aggregated spectrum per display interval reaches the UI
+    displaySampleAccum += uint64_t(ret);
+    const uint64_t displayEvery = std::max<uint64_t>(
+        1, uint64_t(rate / displayRateHz));
+    const bool displayDue = displaySampleAccum >= displayEvery;
+    if (displayDue) {
+      // carry the remainder, but never let a backlog burst several emits
+      displaySampleAccum = std::min(displaySampleAccum - displayEvery,
+                                    displayEvery - 1);
+      aggregator.take(frameAmp.data());
+      // write straight into the mailbox slot; nothing is allocated once the
+      // slots have the current FFT size
+      std::vector<float> &display = mailbox->writeBuffer();
+      display.resize(size_t(activeFftSize));
       for (int i = 0; i < activeFftSize; ++i)
-        ampsShift[i] = amps[(i + half) % activeFftSize];
-      emit newFFTData(ampsShift);
-
-      // Triggered capture logic
-      if (armed.load(std::memory_order_acquire)) {
-        // Continuously spool raw samples to a temporary file so the user
-        // sees a file immediately while armed.
-        if (spoolFile.isOpen()) {
-          spoolFile.write(reinterpret_cast<const char *>(buff.data()),
-                          ret * sizeof(std::complex<float>));
-        }
-        // 1) maintain 1s prebuffer ring
-        if (preBufferCap > 0) {
-          for (int i = 0; i < ret; ++i) {
-            if (preBuffer.empty())
-              break; // safety
-            preBuffer[static_cast<size_t>(preHead)] = buff[i];
-            preHead = (preHead + 1) % preBufferCap;
-            if (preFilled < preBufferCap)
-              ++preFilled;
-          }
-        }
-        totalSamplesSinceArm += static_cast<uint64_t>(ret);
-
-        // 2) detect activity near RX center within ~±100 kHz (or at least ±2
-        // bins)
-        const int half = activeFftSize / 2;
-        double binHz =
-            (activeFftSize > 0) ? (rate / double(activeFftSize)) : 0.0;
-        int winBins = 2;
-        if (binHz > 0.0) {
-          double spanHz = captureSpanHalfHz.load(std::memory_order_acquire);
-          if (spanHz <= 0.0)
-            spanHz = 100000.0; // default ±100 kHz
-          winBins = std::max(2, int(std::ceil(spanHz / binHz)));
-          winBins = std::min(winBins, half - 1);
-        }
-        float centerMax = 0.0f;
-        int startBin = std::max(0, half - winBins);
-        int endBin = std::min(activeFftSize - 1, half + winBins);
-        for (int idx = startBin; idx <= endBin; ++idx)
-          centerMax = std::max(centerMax, ampsShift[idx]);
-        const float eps = 1e-6f;
-        // Choose detector: averaged vs peak
-        double centerDb = 0.0;
-        if (detectorMode.load(std::memory_order_acquire) == 0) {
-          // Averaged detector with ~avgTauSeconds time constant
-          double dtSec = (rate > 0.0) ? (double(ret) / rate) : 0.0;
-          double alphaAvg = 0.0;
-          if (dtSec > 0.0 && avgTauSeconds > 0.0)
-            alphaAvg = 1.0 - std::exp(-dtSec / avgTauSeconds);
-          centerAvgLin =
-              (1.0 - alphaAvg) * centerAvgLin + alphaAvg * double(centerMax);
-          centerDb = 20.0 * std::log10(std::max(centerAvgLin, double(eps)));
-        } else {
-          // Peak detector (instantaneous)
-          centerDb =
-              20.0 * std::log10(std::max(double(centerMax), double(eps)));
+        display[i] = std::min(frameAmp[(i + half) % activeFftSize], 1.5f);
+      mailbox->publish();
+      // at most one wake-up in flight; the GUI always reads the newest frame
+      if (!mailboxPending->exchange(true, std::memory_order_acq_rel))
+        emit spectrumReady();
+      if (thresholdMode != kThresholdFixed && noiseFloor.ready())
+        emit noiseFloorChanged(floorDb, effectiveThresholdDb());
+    }
+
+    // always-on pre-trigger history, so a burst right after arming still
+    // gets its full pre-roll
+    history.write(buff, size_t(ret));
+
+    // channel plan: every watched channel triggers on its own
+    runChannels(buff, ret);
+
+    // Triggered capture logic
+    if (armed) {
+      // Continuously spool raw samples to a temporary file so the user
+      // sees a file immediately while armed.
+      if (spoolHandle >= 0)
+        writer.write(spoolHandle, buff, ret * sizeof(dsp::Cs8));
+      totalSamplesSinceArm += static_cast<uint64_t>(ret);
+
+      // 2) level near the RX centre: one reading per frame from the FFT
+      // bins, or a reading every few tens of microseconds from the
+      // time-domain channel detector
+      detectorReadings.clear();
+      if (detectorMode == kDetectorChannelPower) {
+        if (channelDetectorFresh) {
+          channelDetector.reset(streamIndex);
+          channelDetectorFresh = false;
         }
-        const double thrDb = triggerThresholdDb.load(std::memory_order_acquire);
-        const bool aboveAvg = (centerDb >= thrDb);
-        if (aboveAvg != lastAbove) {
-          lastAbove = aboveAvg;
-          qInfo() << "[RX] Trigger" << (aboveAvg ? "ABOVE" : "below")
-                  << "center(dB)=" << centerDb << "thr(dB)=" << thrDb;
+        channelDetector.process(buff, size_t(ret), kIqScale,
+                                detectorReadings);
+      } else {
+        detectorReadings.push_back({float(fftCenterLevelDb(ret)),
+                                    static_cast<uint32_t>(ret), streamIndex});
+      }
+      const double thrDb = effectiveThresholdDb();
+
+      // 3) run the dwell / post-roll state machine once per reading. The
+      // edges are the first sample of the above streak that satisfied the
+      // dwell and of the below run that satisfied the post-roll; the
+      // capture is cut to them when it is finalized.
+      uint64_t needAbove =
+          static_cast<uint64_t>(std::llround(rate * dwellSeconds));
+      if (detectorMode == kDetectorPeak) {
+        // Peak detector: require just one block above
+        needAbove = std::max<uint64_t>(ret, 1);
+      }
+      const uint64_t needPost =
+          static_cast<uint64_t>(std::llround(rate * postSeconds));
+      bool startNow = false;
+      bool endNow = false;
+      bool aboveAvg = false;
+      double centerDb = -std::numeric_limits<double>::infinity();
+      for (const ChannelPowerDetector::Reading &r : detectorReadings) {
+        const bool above = r.levelDb >= thrDb;
+        aboveAvg = aboveAvg || above;
+        centerDb = std::max(centerDb, double(r.levelDb));
+        // one capture per arm: nothing after the release counts
+        if (endNow || captureReleased)
+          continue;
+        switch (gate.step(above, r.first, r.samples, needAbove, needPost)) {
+        case TriggerGate::Rise:
+          startNow = true;
+          triggerIndex = gate.riseIndex();
+          break;
+        case TriggerGate::Fall:
+          endNow = true;
+          releaseIndex = gate.fallIndex();
+          break;
+        case TriggerGate::None:
+          break;
         }
+      }
+      // the frame is reported by its loudest reading
+      if (detectorReadings.empty())
+        centerDb = lastCenterDb;
+      lastCenterDb = centerDb;
+      if (aboveAvg != lastAbove) {
+        lastAbove = aboveAvg;
+        qInfo() << "[RX] Trigger" << (aboveAvg ? "ABOVE" : "below")
+                << "center(dB)=" << centerDb << "thr(dB)=" << thrDb;
+      }
 
-        // accumulate above time for dwell requirement
-        if (aboveAvg)
-          aboveStreakSamples += static_cast<uint64_t>(ret);
-        else
-          aboveStreakSamples = 0;
-
-        // Light-weight periodic notification while above threshold
-        if (aboveAvg) {
-          peakLogAccum += static_cast<uint64_t>(ret);
-          const uint64_t need =
-              static_cast<uint64_t>(std::llround(rate * peakLogSeconds));
-          if (peakLogAccum >= std::max<uint64_t>(need, 1)) {
-            qInfo() << "[RX] Peak detected" << "center(dB)=" << centerDb
-                    << "thr(dB)=" << thrDb;
-            peakLogAccum = 0;
-          }
-        } else {
+      // Light-weight periodic notification while above threshold
+      if (aboveAvg) {
+        peakLogAccum += static_cast<uint64_t>(ret);
+        const uint64_t need =
+            static_cast<uint64_t>(std::llround(rate * peakLogSeconds));
+        if (peakLogAccum >= std::max<uint64_t>(need, 1)) {
+          qInfo() << "[RX] Peak detected" << "center(dB)=" << centerDb
+                  << "thr(dB)=" << thrDb;
           peakLogAccum = 0;
         }
+      } else {
+        peakLogAccum = 0;
+      }
 
-        // notify trigger status based on averaged value
-        emit triggerStatus(true, inCapture.load(std::memory_order_acquire),
-                           centerDb, thrDb, aboveAvg);
-        // periodic debug log while armed
-        logSamplesAccum += static_cast<uint64_t>(ret);
-        const uint64_t logEvery =
-            static_cast<uint64_t>(std::llround(rate * 0.5));
-        if (logSamplesAccum >= std::max<uint64_t>(logEvery, 1)) {
-          qInfo() << "[RX] Armed center(dB)=" << centerDb << "thr(dB)=" << thrDb
-                  << "above=" << aboveAvg
-                  << "capturing=" << inCapture.load(std::memory_order_acquire);
-          logSamplesAccum = 0;
-        }
+      // periodic debug log while armed
+      logSamplesAccum += static_cast<uint64_t>(ret);
+      const uint64_t logEvery =
+          static_cast<uint64_t>(std::llround(rate * 0.5));
+      if (logSamplesAccum >= std::max<uint64_t>(logEvery, 1)) {
+        qInfo() << "[RX] Armed center(dB)=" << centerDb << "thr(dB)=" << thrDb
+                << "above=" << aboveAvg
+                << "capturing=" << inCapture;
+        logSamplesAccum = 0;
+      }
 
-        if (!inCapture.load(std::memory_order_acquire)) {
-          uint64_t needAbove =
-              static_cast<uint64_t>(std::llround(rate * dwellSeconds));
-          if (detectorMode.load(std::memory_order_acquire) == 1) {
-            // Peak detector: require just one block above
-            needAbove = std::max<uint64_t>(ret, 1);
-          }
-          if (aboveStreakSamples >= needAbove) {
-            // Start capture: copy prebuffer content in chronological order
-            inCapture.store(true, std::memory_order_release);
-            captureBuffer.clear();
-            qInfo() << "[RX] Capture START (preFilled=" << preFilled
-                    << ", fftSize=" << activeFftSize << ")";
-            if (preFilled > 0 && !preBuffer.empty()) {
-              uint64_t count = preFilled;
-              uint64_t head =
-                  preHead; // points to oldest position to be overwritten next
-              // oldest sample is at head when full; when partially filled,
-              // oldest at 0
-              if (preFilled == preBufferCap) {
-                // full ring: start from head to end, then 0 to head-1
-                for (uint64_t i = 0; i < preBufferCap; ++i) {
-                  uint64_t idx = (head + i) % preBufferCap;
-                  captureBuffer.push_back(preBuffer[static_cast<size_t>(idx)]);
-                }
-              } else {
-                // not full yet: take 0..preFilled-1
-                captureBuffer.insert(captureBuffer.end(), preBuffer.begin(),
-                                     preBuffer.begin() +
-                                         static_cast<long>(preFilled));
-              }
-            }
-            // include current chunk
-            captureBuffer.insert(captureBuffer.end(), buff.begin(),
-                                 buff.begin() + ret);
-            belowSamples = 0;
-          }
-        } else {
-          // already capturing, keep appending
-          captureBuffer.insert(captureBuffer.end(), buff.begin(),
-                               buff.begin() + ret);
-          if (aboveAvg) {
-            belowSamples = 0;
-          } else {
-            belowSamples += static_cast<uint64_t>(ret);
-            const uint64_t needPost =
-                static_cast<uint64_t>(std::llround(rate * postSeconds));
-            if (belowSamples >= needPost) {
-              // finalize: band-limit to capture span and decimate to a
-              // narrower sample rate so the recording only contains the
-              // capture span bandwidth around RX.
-              // Compute decimation factor D such that outRate >=
-              // 2*captureSpanHalfHz * guard, where guard>1 for transition.
-              double spanHalf =
-                  captureSpanHalfHz.load(std::memory_order_acquire);
-              spanHalf = std::max(1.0, spanHalf);
-              // Choose decimation so outRate >= 2*spanHalf (complex Nyquist)
-              // and as close as possible to minimize extra bandwidth.
-              int D = 1;
-              if (rate > 0.0) {
-                D = std::max(1, int(std::floor(rate / (2.0 * spanHalf))));
-              }
-              double outRate = (D > 0) ? (rate / double(D)) : rate;
-              // Low-pass cutoff slightly below span edge and below Nyquist
-              double cutoff = std::min(spanHalf * 0.90, 0.45 * outRate);
-              // FIR length (odd)
-              const int NTaps = 129;
-
-              auto designLowpass = [&](double cutoffHz, double fs, int taps) {
-                std::vector<float> h;
-                h.resize(std::max(3, taps));
-                int M = int(h.size());
-                double fc = std::clamp(cutoffHz / fs, 1e-6, 0.49); // 0..0.5
-                int mid = (M - 1) / 2;
-                double sum = 0.0;
-                for (int n = 0; n < M; ++n) {
-                  double m = double(n - mid);
-                  double wnd = 0.42 - 0.5 * std::cos(2.0 * M_PI * n / (M - 1)) +
-                               0.08 * std::cos(4.0 * M_PI * n / (M - 1));
-                  double sinc;
-                  if (std::abs(m) < 1e-12)
-                    sinc = 1.0;
-                  else
-                    sinc = std::sin(2.0 * M_PI * fc * m) / (M_PI * m);
-                  double val = 2.0 * fc * sinc * wnd;
-                  h[n] = float(val);
-                  sum += val;
-                }
-                if (sum != 0.0) {
-                  for (auto &v : h)
-                    v = float(double(v) / sum);
-                }
-                return h;
-              };
-
-              auto decimateFIR = [&](const std::vector<std::complex<float>> &x,
-                                     const std::vector<float> &h, int Ddec) {
-                std::vector<std::complex<float>> y;
-                if (x.empty() || h.empty() || Ddec <= 0)
-                  return y;
-                int M = int(h.size());
-                int start = M - 1; // need M samples to start
-                for (int i = start; i < int(x.size()); i += Ddec) {
-                  std::complex<float> acc(0.0f, 0.0f);
-                  // Convolve reversed taps: x[i-k] * h[k]
-                  for (int k = 0; k < M; ++k) {
-                    int idx = i - k;
-                    if (idx < 0)
-                      break;
-                    acc += x[size_t(idx)] * h[size_t(k)];
-                  }
-                  y.push_back(acc);
-                }
-                return y;
-              };
-
-              std::vector<float> lpf = designLowpass(cutoff, rate, NTaps);
-              std::vector<std::complex<float>> reduced =
-                  decimateFIR(captureBuffer, lpf, std::max(1, D));
-
-              // Write result to disk
-              QString outPath = makeCapturePath();
-              if (!outPath.isEmpty()) {
-                QFile out(outPath);
-                if (out.open(QIODevice::WriteOnly)) {
-                  if (!reduced.empty()) {
-                    out.write(reinterpret_cast<const char *>(reduced.data()),
-                              qint64(reduced.size() *
-                                     sizeof(std::complex<float>)));
-                  }
-                  out.close();
-                }
-              }
-              qInfo() << "[RX] Capture COMPLETE ->" << outPath
-                      << "samples(in)=" << captureBuffer.size()
-                      << "samples(out)=" << reduced.size() << "D=" << D
-                      << "outRate=" << outRate;
-              // cleanup spooling temp
-              if (spoolFile.isOpen())
-                spoolFile.close();
-              if (!spoolPath.isEmpty()) {
-                QFile::remove(spoolPath);
-                spoolPath.clear();
-              }
-              // reset
-              armed.store(false, std::memory_order_release);
-              inCapture.store(false, std::memory_order_release);
-              belowSamples = 0;
-              totalSamplesSinceArm = 0;
-              preHead = 0;
-              preFilled = 0;
-              preBuffer.clear();
-              captureBuffer.clear();
-              centerAvgLin = 0.0;
-              aboveStreakSamples = 0;
-              emit captureCompleted(outPath);
-            }
-          }
-        }
+      // one event, one file: another device that triggered first for
+      // this arm writes it, and this one stands down
+      if (startNow && !claimCapture()) {
+        qInfo() << "[RX] Trigger taken by another device, disarming";
+        disarm();
+        startNow = endNow = false;
       }
+      if (startNow)
+        startTriggeredCapture(ret);
+      else if (inCapture)
+        feedCapture(buff, size_t(ret)); // already capturing, keep appending
+      // past the release, record on until the last kept output (release
+      // + post-roll) has real samples under its whole filter span, so the
+      // job's zero flush only reaches outputs that are trimmed off
+      if (endNow) {
+        captureReleased = true;
+        captureEndIndex = releaseIndex +
+                          uint64_t(std::llround(rate * postSeconds)) +
+                          uint64_t(std::ceil(captureDelay)) +
+                          uint64_t(captureDecimator.factor());
+      }
+      if (captureReleased && streamIndex + uint64_t(ret) >= captureEndIndex)
+        finishTriggeredCapture();
 
-      // optional capture
-      if (capturing && file.isOpen()) {
-        file.write(reinterpret_cast<const char *>(buff.data()),
-                   ret * sizeof(std::complex<float>));
+      // notify trigger status based on averaged value, at display rate
+      // unless the state flips; sent after the capture started or ended
+      // so it reports this frame's state, and once more on disarming
+      if (displayDue || aboveAvg != statusAbove ||
+          inCapture != statusCapturing || !armed) {
+        statusAbove = aboveAvg;
+        statusCapturing = inCapture;
+        emit triggerStatus(armed, inCapture, centerDb, thrDb, aboveAvg);
       }
+    }
 
-      if (reconfigureRequested.exchange(false)) {
-        // Consume latest pending config
-        double f = pendingFreqHz.load(std::memory_order_acquire);
-        double r = pendingRate.load(std::memory_order_acquire);
-        double g = pendingGain.load(std::memory_order_acquire);
-        freqHz = f;
-        rate = r;
-        gainDb = g;
-        applyTuning();
+    // optional capture
+    if (capturing && fileHandle >= 0) {
+      if (manualInfo.samples == 0) {
+        manualInfo.startSample = double(first);
+        manualInfo.startTimeNs = utcNsAt(double(first));
       }
+      if (!writer.write(fileHandle, buff, ret * sizeof(dsp::Cs8))) {
+        // the writer leaves the block as zeros; note it like a stream gap
+        if (!manualGaps.empty() &&
+            manualGaps.back().cause == StreamGap::Unwritten &&
+            manualGaps.back().index + manualGaps.back().samples == first)
+          manualGaps.back().samples += quint64(ret);
+        else
+          manualGaps.push_back({first, quint64(ret), StreamGap::Unwritten});
+      }
+      manualInfo.samples += quint64(ret);
     }
-    closeDevice();
-    freeFFTW();
   }
-
-  void stopWork() { running = false; }
-
-  void beginCapture(const QString &path) {
-    if (file.isOpen())
-      file.close();
-    file.setFileName(path);
-    if (!file.open(QIODevice::WriteOnly)) {
-      capturing = false;
+  // Half-width of the detection window around the RX centre.
+  double detectionSpanHz() const {
+    return captureSpanHalfHz > 0.0 ? captureSpanHalfHz
+                                   : 100000.0; // default ±100 kHz
+  }
+  // FFT-shifted bins of the detection span (or at least ±2 bins).
+  void detectionBins(int &startBin, int &endBin) const {
+    const int half = activeFftSize / 2;
+    double binHz = (activeFftSize > 0) ? (rate / double(activeFftSize)) : 0.0;
+    int winBins = 2;
+    if (binHz > 0.0) {
+      winBins = std::max(2, int(std::ceil(detectionSpanHz() / binHz)));
+      winBins = std::min(winBins, half - 1);
+    }
+    startBin = std::max(0, half - winBins);
+    endBin = std::min(activeFftSize - 1, half + winBins);
+  }
+  // FFT detectors: strongest bin within the span of the current frame,
+  // averaged over ~avgTauSeconds in Averaged mode.
+  double fftCenterLevelDb(int ret) {
+    int startBin = 0;
+    int endBin = 0;
+    detectionBins(startBin, endBin);
+    float centerMax = std::max(
+        0.0f,
+        dsp::maxValue(ampsShift.data() + startBin, endBin - startBin + 1));
+    const float eps = 1e-6f;
+    if (detectorMode == kDetectorAveraged) {
+      double dtSec = (rate > 0.0) ? (double(ret) / rate) : 0.0;
+      double alphaAvg = 0.0;
+      if (dtSec > 0.0 && avgTauSeconds > 0.0)
+        alphaAvg = 1.0 - std::exp(-dtSec / avgTauSeconds);
+      centerAvgLin =
+          (1.0 - alphaAvg) * centerAvgLin + alphaAvg * double(centerMax);
+      return 20.0 * std::log10(std::max(centerAvgLin, double(eps)));
+    }
+    // Peak detector (instantaneous)
+    return 20.0 * std::log10(std::max(double(centerMax), double(eps)));
+  }
+  // Feeds the frame's bin powers to the CFAR noise estimate and reads the
+  // floor next to the detection span. The estimate holds still while a
+  // triggered capture runs, so a long burst cannot raise its own threshold.
+  void updateNoiseFloor(int ret) {
+    if (thresholdMode == kThresholdFixed)
       return;
+    if (noiseFloorFresh || noiseFloor.bins() != activeFftSize) {
+      // the window is counted in frames of `ret` fresh samples
+      const int frames = std::max(
+          1, int(std::lround(kCfarWindowSeconds * rate / std::max(ret, 1))));
+      noiseFloor.configure(activeFftSize, frames);
+      noiseFloorFresh = false;
+      qInfo() << "[RX] CFAR window" << noiseFloor.windowFrames() << "frames";
     }
-    capturing = true;
-    qInfo() << "[RX] Manual capture BEGIN ->" << path;
+    if (inCapture && noiseFloor.ready())
+      return;
+    const int half = activeFftSize / 2;
+    framePower.resize(size_t(activeFftSize));
+    for (int i = 0; i < activeFftSize; ++i) {
+      const float a = frameAmp[(i + half) % activeFftSize];
+      framePower[size_t(i)] = a * a;
+    }
+    noiseFloor.add(framePower.data());
+    int startBin = 0;
+    int endBin = 0;
+    detectionBins(startBin, endBin);
+    const int width = endBin - startBin + 1;
+    const double power = noiseFloor.floor(
+        startBin, endBin, std::max(kCfarGuardBins, width / 4),
+        std::max(kCfarReferenceBins, width),
+        thresholdMode == kThresholdOsCfar
+            ? NoiseFloorEstimator::OrderedStatistic
+            : NoiseFloorEstimator::CellAveraging);
+    floorDb = 10.0 * std::log10(std::max(power, 1e-12));
   }
-  void endCapture() {
-    capturing = false;
-    if (file.isOpen())
-      file.close();
-    qInfo() << "[RX] Manual capture END";
+  // Trigger threshold for the current detector. CFAR puts it cfarMarginDb
+  // above the floor; the channel power detector integrates the whole span
+  // rather than reading one bin, so its floor is scaled from the per-bin
+  // noise by span / (bin width * window noise bandwidth).
+  double effectiveThresholdDb() const {
+    if (thresholdMode == kThresholdFixed || !noiseFloor.ready())
+      return triggerThresholdDb;
+    double floor = floorDb;
+    if (detectorMode == kDetectorChannelPower && activeFftSize > 0) {
+      const double binHz = rate / double(activeFftSize);
+      floor += 10.0 * std::log10(std::max(
+                          2.0 * detectionSpanHz() / (binHz * noiseBandwidth),
+                          1.0));
+    }
+    return floor + cfarMarginDb;
   }
-  void updateFftSize(int size) {
-    int clamped = std::clamp(size, 512, 8192);
-    requestedFftSize.store(clamped, std::memory_order_release);
+  // Rebuilds the time-domain detector for the current rate and span.
+  void configureChannelDetector() {
+    channelDetector.configure(rate, 0.0, detectionSpanHz());
+    channelDetectorFresh = true; // rebased on the next frame it sees
+    qInfo() << "[RX] Channel detector window="
+            << channelDetector.windowSamples() << "samples, resolution(us)="
+            << channelDetector.resolutionSeconds() * 1e6;
+  }
+  // Start capture: pre-roll before triggerIndex up to the end of the
+  // current chunk, which the history already holds, in chronological order
+  void startTriggeredCapture(int ret) {
+    inCapture = true;
+    // the capture is band-limited and resampled as it is recorded, so the
+    // buffer only ever holds the output rate
+    configureCaptureChain();
+    // output n of the chain is centred on input
+    // captureFirstIndex + captureDelay + n * rate / outRate; feeding that
+    // much earlier puts the first output at the start of the pre-roll
+    captureDelay = captureDecimator.delay() +
+                   double(captureDecimator.factor()) * captureResampler.delay();
+    const uint64_t preSamples =
+        static_cast<uint64_t>(std::llround(rate * preSeconds));
+    const uint64_t lead = preSamples + uint64_t(std::ceil(captureDelay));
+    const uint64_t end = streamIndex + uint64_t(ret);
+    const uint64_t oldest = end - std::min<uint64_t>(end, history.size());
+    captureFirstIndex = triggerIndex > lead ? triggerIndex - lead : 0;
+    if (captureFirstIndex < oldest) {
+      qWarning() << "[RX] Pre-roll short by" << oldest - captureFirstIndex
+                 << "samples (history)";
+      captureFirstIndex = oldest;
+    }
+    const auto pre = history.latest(size_t(end - captureFirstIndex));
+    captureBuffer.clear();
+    captureBuffer.reserve(static_cast<size_t>(
+        double(pre.size()) * captureResampler.outputRate() / rate +
+        captureResampler.outputRate() * (postSeconds + 1.0)));
+    feedCapture(pre.first, pre.firstLen);
+    feedCapture(pre.second, pre.secondLen);
+    qInfo() << "[RX] Capture START (trigger@" << triggerIndex
+            << ", pre=" << triggerIndex - captureFirstIndex
+            << ", fftSize=" << activeFftSize
+            << ", D=" << captureDecimator.factor()
+            << ", halfbands=" << captureDecimator.halfbandStages()
+            << ", L/M=" << captureResampler.up() << "/"
+            << captureResampler.down()
+            << ", outRate=" << captureResampler.outputRate() << ")";
   }
-  void setCaptureSpanHzSlot(double halfSpanHz) { setCaptureSpan(halfSpanHz); }
+  // Finalize off this thread: the job takes the reduced buffer and the
+  // filter chain, flushes its tail and writes the file while we keep
+  // streaming.
+  void finishTriggeredCapture() {
+    // keep the outputs centred in [trigger - pre, release + post)
+    const double step = rate / captureResampler.outputRate();
+    const double t0 = double(captureFirstIndex) + captureDelay;
+    const double from = double(triggerIndex) - std::round(rate * preSeconds);
+    const double to = double(releaseIndex) + std::round(rate * postSeconds);
+    const auto outputsBefore = [&](double t) {
+      return t > t0 ? size_t(std::ceil((t - t0) / step - 1e-9)) : size_t(0);
+    };
+    const size_t skip = outputsBefore(from);
+    const size_t stop = std::max(skip, outputsBefore(to));
 
-  // Thread-safe: may be called from any thread
-  void configureImmediate(double freqMHz, double sampleRate) {
-    pendingFreqHz.store(freqMHz * 1e6, std::memory_order_release);
-    pendingRate.store(sampleRate, std::memory_order_release);
-    reconfigureRequested.store(true, std::memory_order_release);
+    CaptureResult info;
+    info.filePath = makeCapturePath();
+    info.centerHz = freqHz;
+    info.sampleRate = captureResampler.outputRate();
+    info.triggerSample = triggerIndex;
+    info.releaseSample = releaseIndex;
+    info.triggerTimeNs = utcNsAt(double(triggerIndex));
+    info.releaseTimeNs = utcNsAt(double(releaseIndex));
+    info.startTimeNs = utcNsAt(t0 + double(skip) * step);
+    fillCaptureInfo(info);
+    info.startSample = t0 + double(skip) * step;
+    info.triggerOffset = fileOffset(info, double(triggerIndex), step);
+    info.releaseOffset = fileOffset(info, double(releaseIndex), step);
+    info.armTimeNs = armStartTime.toMSecsSinceEpoch() * 1000000;
+    info.gaps = gapsInFile(recentGaps, info.startSample, step, stop - skip);
+    qInfo() << "[RX] Capture END release@" << releaseIndex
+            << "samples(out)=" << stop - skip << "-> finalizing"
+            << info.filePath;
+    auto *job = new CaptureJob(
+        std::move(captureBuffer), std::move(captureDecimator),
+        std::move(captureResampler), info, &writer, &finalizeGeneration);
+    job->trimFront = skip;
+    job->trimLength = stop - skip;
+    job->onProgress = [this](int percent) { emit captureProgress(percent); };
+    job->onFinished = [this](const CaptureResult &result) {
+      emit captureCompleted(result);
+    };
+    finalizePool.start(job);
+    captureBuffer = {};
+    captureDecimator = Decimator();
+    captureResampler = Resampler();
+    disarm();
+  }
+  // Drops the spool and the trigger state; a finalize already queued
+  // carries on.
+  void disarm() {
+    // cleanup spooling temp
+    if (spoolHandle >= 0)
+      writer.close(spoolHandle, true);
+    spoolHandle = -1;
+    spoolPath.clear();
+    // reset
+    armed = false;
+    inCapture = false;
+    captureReleased = false;
+    gate.reset();
+    totalSamplesSinceArm = 0;
+    centerAvgLin = 0.0;
+  }
+  // Each arm is numbered and the claim holds the newest number a device
+  // has triggered on; the first device to raise it takes that arm's
+  // capture. A worker still on an older arm only raises it to that one.
+  bool claimCapture() {
+    int claimed = captureClaim->load(std::memory_order_acquire);
+    while (claimed < armGeneration) {
+      if (captureClaim->compare_exchange_weak(claimed, armGeneration,
+                                              std::memory_order_acq_rel))
+        return true;
+    }
+    return false;
+  }
+  void setChannelPlan(const ChannelPlan &plan) {
+    // the old plan's captures still queued for writing are dropped
+    channelGeneration.fetch_add(1, std::memory_order_acq_rel);
+    channelPlan = plan;
+    configureChannels();
+  }
+  // Rebuilds the filter bank and the per-channel state for the current
+  // plan and rate; captures in progress are abandoned.
+  void configureChannels() {
+    channelTriggers.clear();
+    channelFresh = true;
+    if (channelPlan.channels < 2 || channelPlan.watches.isEmpty())
+      return;
+    channelizer.configure(channelPlan.channels);
+    const double chanRate = rate / double(channelizer.channels());
+    channelWindow = std::max(
+        1, int(std::lround(ChannelPowerDetector::kDefaultWindowSeconds *
+                           chanRate)));
+    for (const ChannelWatch &w : channelPlan.watches) {
+      if (w.channel < 0 || w.channel >= channelizer.channels()) {
+        qWarning() << "[RX] Channel plan: no channel" << w.channel;
+        continue;
+      }
+      ChannelTrigger t;
+      t.watch = w;
+      const double seconds =
+          std::max(kHistorySeconds, w.preSeconds + w.dwellSeconds);
+      t.history.reset(static_cast<size_t>(std::llround(chanRate * seconds)) +
+                      kHistorySlack / size_t(channelizer.channels()));
+      channelTriggers.push_back(std::move(t));
+    }
+    qInfo() << "[RX] Channel plan" << channelizer.channels() << "channels of"
+            << chanRate << "Hz," << channelTriggers.size() << "watched";
+  }
+  // Stream position (sample index) of channel sample i.
+  double channelStreamIndex(uint64_t i) const {
+    return double(channelBase) + channelizer.delay() +
+           double(i) * double(channelizer.channels());
+  }
+  // Channelizes one block and runs each watched channel's trigger on it.
+  void runChannels(const dsp::Cs8 *buff, int ret) {
+    if (channelTriggers.empty())
+      return;
+    if (channelFresh) {
+      channelizer.reset();
+      channelBase = streamIndex;
+      channelSamples = 0;
+      channelFresh = false;
+    }
+    channelIq.resize(size_t(ret));
+    dsp::cs8ToComplex(buff, kIqScale, channelIq.data(), ret);
+    for (std::vector<std::complex<float>> &y : channelOut)
+      y.clear();
+    channelizer.process(channelIq.data(), size_t(ret), channelOut);
+    const size_t n = channelOut[0].size();
+    const uint64_t first = channelSamples;
+    channelSamples += n;
+    if (n == 0)
+      return;
+    const double chanRate = rate / double(channelizer.channels());
+    for (ChannelTrigger &t : channelTriggers) {
+      const std::vector<std::complex<float>> &y =
+          channelOut[size_t(t.watch.channel)];
+      t.history.write(y.data(), n);
+      if (t.capturing)
+        t.capture.insert(t.capture.end(), y.begin(), y.end());
+      const uint64_t needAbove =
+          static_cast<uint64_t>(std::llround(chanRate * t.watch.dwellSeconds));
+      const uint64_t needPost =
+          static_cast<uint64_t>(std::llround(chanRate * t.watch.postSeconds));
+      for (size_t i = 0; i < n; ++i) {
+        if (t.accCount == 0)
+          t.accFirst = first + i;
+        t.accPower += double(std::norm(y[i]));
+        if (++t.accCount < channelWindow)
+          continue;
+        const double levelDb = 10.0 * std::log10(std::max(
+                                          t.accPower / double(channelWindow),
+                                          1e-12));
+        t.accPower = 0.0;
+        t.accCount = 0;
+        switch (t.gate.step(levelDb >= t.watch.thresholdDb, t.accFirst,
+                            uint64_t(channelWindow), needAbove, needPost)) {
+        case TriggerGate::Rise:
+          startChannelCapture(t, first + n);
+          break;
+        case TriggerGate::Fall:
+          finishChannelCapture(t);
+          break;
+        case TriggerGate::None:
+          break;
+        }
+      }
+    }
+  }
+  // Pre-roll before the rising edge up to `end`, the channel sample after
+  // the current block, out of the channel's history.
+  void startChannelCapture(ChannelTrigger &t, uint64_t end) {
+    const double chanRate = rate / double(channelizer.channels());
+    const uint64_t pre =
+        static_cast<uint64_t>(std::llround(chanRate * t.watch.preSeconds));
+    const uint64_t rise = t.gate.riseIndex();
+    const uint64_t oldest = end - std::min<uint64_t>(end, t.history.size());
+    t.captureFirst = rise > pre ? rise - pre : 0;
+    if (t.captureFirst < oldest) {
+      qWarning() << "[RX] Channel" << t.watch.channel << "pre-roll short by"
+                 << oldest - t.captureFirst << "samples (history)";
+      t.captureFirst = oldest;
+    }
+    const auto h = t.history.latest(size_t(end - t.captureFirst));
+    t.capture.clear();
+    t.capture.reserve(h.size() + static_cast<size_t>(
+                                     chanRate * (t.watch.postSeconds + 1.0)));
+    t.capture.insert(t.capture.end(), h.first, h.first + h.firstLen);
+    t.capture.insert(t.capture.end(), h.second, h.second + h.secondLen);
+    t.capturing = true;
+    qInfo() << "[RX] Channel" << t.watch.channel << "capture START (trigger@"
+            << channelStreamIndex(rise) << ", pre=" << rise - t.captureFirst
+            << ")";
   }
+  // The channel samples are already at their final rate, so the job gets
+  // a pass-through chain and only trims and writes.
+  void finishChannelCapture(ChannelTrigger &t) {
+    const double chanRate = rate / double(channelizer.channels());
+    const uint64_t rise = t.gate.riseIndex();
+    const uint64_t fall = t.gate.fallIndex();
+    const uint64_t post =
+        static_cast<uint64_t>(std::llround(chanRate * t.watch.postSeconds));
+    const uint64_t stop = fall + post;
+    const int k = t.watch.channel;
 
-private:
+    CaptureResult info;
+    info.centerHz = freqHz + channelizer.channelOffset(k) * rate;
+    info.filePath = makeChannelCapturePath(k, info.centerHz);
+    info.sampleRate = chanRate;
+    info.triggerSample = quint64(std::llround(channelStreamIndex(rise)));
+    info.releaseSample = quint64(std::llround(channelStreamIndex(fall)));
+    info.triggerTimeNs = utcNsAt(channelStreamIndex(rise));
+    info.releaseTimeNs = utcNsAt(channelStreamIndex(fall));
+    info.startTimeNs = utcNsAt(channelStreamIndex(t.captureFirst));
+    fillCaptureInfo(info);
+    info.decimation = channelizer.channels();
+    info.startSample = channelStreamIndex(t.captureFirst);
+    info.triggerOffset = rise - t.captureFirst;
+    info.releaseOffset = fall - t.captureFirst;
+    info.gaps = gapsInFile(recentGaps, info.startSample,
+                           double(channelizer.channels()),
+                           stop - t.captureFirst);
+    qInfo() << "[RX] Channel" << k << "capture END samples(out)="
+            << stop - t.captureFirst << "-> finalizing" << info.filePath;
+    auto *job = new CaptureJob(std::move(t.capture), Decimator(), Resampler(),
+                               info, &writer, &channelGeneration);
+    job->trimLength = size_t(stop - t.captureFirst);
+    job->onFinished = [this, k](const CaptureResult &result) {
+      emit channelCaptureCompleted(k, result);
+    };
+    finalizePool.start(job);
+    t.capture = {};
+    t.capturing = false;
+  }
+  // Receiver settings every capture's sidecar records.
+  void fillCaptureInfo(CaptureResult &info) const {
+    info.device = deviceInfo.serial.isEmpty()
+                      ? deviceInfo.label
+                      : deviceInfo.label + " SN " + deviceInfo.serial;
+    info.gainDb = gainDb;
+    info.inputRate = rate;
+  }
+  // Sample of the file (first sample centred on info.startSample, `step`
+  // stream samples apart) nearest to stream position `index`.
+  static quint64 fileOffset(const CaptureResult &info, double index,
+                            double step) {
+    return quint64(
+        std::max(0ll, std::llround((index - info.startSample) / step)));
+  }
+  void buildHann(int N) {
+    window.resize(N);
+    double sumW = 0.0;
+    for (int i = 0; i < N; ++i) {
+      float w =
+          0.5f * (1.0f - std::cos(2.0f * float(M_PI) * float(i) / float(N - 1)));
+      window[i] = w;
+      sumW += w;
+    }
+    coherentGain = float(sumW / double(N));
+    double sumW2 = 0.0;
+    for (float w : window)
+      sumW2 += double(w) * double(w);
+    noiseBandwidth = double(N) * sumW2 / std::max(sumW * sumW, 1e-12);
+    noiseFloorFresh = true;
+    prevAmp.assign(N, 0.0f);
+    frameAmp.assign(N, 0.0f);
+    amps.assign(N, 0.0f);
+    ampsShift.assign(N, 0.0f);
+    aggregator.reset(N);
+  }
   QString makeCapturePath() {
     QDir().mkpath("captures");
     QString ts = armStartTime.toString("yyyyMMdd_HHmmss");
     double rxMHz = freqHz / 1e6;
-    double thr = triggerThresholdDb.load(std::memory_order_acquire);
-    return QString("captures/%1_RX%2_thr%3.cf32")
+    double thr = triggerThresholdDb;
+    return QString("captures/%1_RX%2_thr%3%4.cf32")
         .arg(ts)
         .arg(rxMHz, 0, 'f', 3)
-        .arg(thr, 0, 'f', 0);
+        .arg(thr, 0, 'f', 0)
+        .arg(deviceSuffix());
+  }
+  QString makeChannelCapturePath(int channel, double centerHz) {
+    QDir().mkpath("captures");
+    QString ts =
+        QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz");
+    return QString("captures/%1_CH%2_%3%4.cf32")
+        .arg(ts)
+        .arg(channel)
+        .arg(centerHz / 1e6, 0, 'f', 3)
+        .arg(deviceSuffix());
+  }
+  // keeps the files of several SDRs triggering together apart; the first
+  // one keeps the plain names
+  QString deviceSuffix() const {
+    return pipelineIndex > 0 ? QString("_D%1").arg(pipelineIndex) : QString();
   }
   void openDevice() {
     try {
+      // the exact device discovery found, else the first RTL-SDR
       SoapySDR::Kwargs args;
-      args["driver"] = "rtlsdr";
+      for (auto it = deviceInfo.args.cbegin(); it != deviceInfo.args.cend();
+           ++it)
+        args[it.key().toStdString()] = it.value().toStdString();
+      if (args.empty())
+        args["driver"] = "rtlsdr";
       dev = SoapySDR::Device::make(args);
-      stream = dev->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
-      applyTuning();
+      // keep the device's 8-bit samples as they are; drivers without CS8
+      // get CS16, narrowed by the reader
+      std::vector<std::string> formats;
+      if (deviceInfo.probed) {
+        for (const QString &f : deviceInfo.streamFormats)
+          formats.push_back(f.toStdString());
+      } else {
+        formats = dev->getStreamFormats(SOAPY_SDR_RX, 0);
+      }
+      streamCs16 = std::find(formats.begin(), formats.end(),
+                             SOAPY_SDR_CS8) == formats.end();
+      stream = dev->setupStream(SOAPY_SDR_RX,
+                                streamCs16 ? SOAPY_SDR_CS16 : SOAPY_SDR_CS8);
+      // the DSP side is already set up for this tuning
+      setupControls();
+      applyDeviceSettings();
       dev->activateStream(stream);
-      qInfo() << "[RX] Device opened + stream activated";
+      qInfo() << "[RX] Device opened + stream activated, format"
+              << (streamCs16 ? "CS16 -> CS8" : "CS8");
+      startReader();
     } catch (...) {
       qWarning() << "[RX] Failed to open RTL-SDR device";
+      if (dev) {
+        if (stream)
+          dev->closeStream(stream);
+        SoapySDR::Device::unmake(dev);
+      }
       dev = nullptr;
       stream = nullptr;
     }
   }
+  // Stream watchdog (DSP thread). The device failing to open, the reader
+  // giving up on read errors, or no samples for kStallMs all count as a
+  // fault: the device is closed and reopened after a delay that doubles
+  // from kRetryMinMs up to kRetryMaxMs. Only the device and the reader
+  // restart; FFT plans, the history ring and the armed trigger and channel
+  // state carry on, and the outage is recorded as a Restart gap. True
+  // while the stream is up.
+  bool superviseStream() {
+    if (dev) {
+      const bool failed = readerFailed.load(std::memory_order_acquire);
+      if (!failed && lastSamples.elapsed() < kStallMs)
+        return true;
+      closeDevice();
+      streamFault(failed ? "read errors" : "stream stalled");
+      return false;
+    }
+    if (retryTimer.isValid() && retryTimer.elapsed() < retryDelayMs)
+      return false;
+    if (degraded) {
+      ++retryAttempt;
+      qInfo() << "[RX] Reopening device, attempt" << retryAttempt;
+      emit streamRecovering(retryAttempt);
+    }
+    openDevice();
+    if (!dev) {
+      streamFault("device unavailable");
+      return false;
+    }
+    lastSamples.start();
+    if (degraded) {
+      // how many samples the outage cost is unknown, only where it was
+      ++restarts;
+      noteGap({assembler.samplesIn(), 0, StreamGap::Restart});
+      const qint64 ms = outage.elapsed();
+      qInfo() << "[RX] Stream recovered after" << ms << "ms";
+      emit streamRecovered(int(ms));
+    }
+    degraded = false;
+    retryAttempt = 0;
+    retryTimer.invalidate();
+    return true;
+  }
+  void streamFault(const QString &reason) {
+    if (degraded) {
+      retryDelayMs = std::min(retryDelayMs * 2, kRetryMaxMs);
+    } else {
+      degraded = true;
+      outage.start();
+      retryDelayMs = kRetryMinMs;
+      qWarning() << "[RX] Stream degraded:" << reason;
+      emit streamDegraded(reason);
+    }
+    retryTimer.start();
+  }
+  // Dedicated reader: drains the driver in MTU-sized blocks into the ring so
+  // slow FFT/trigger/disk work on the DSP thread never stalls USB transfers.
+  void startReader() {
+    if (reader || !dev || !stream)
+      return;
+    size_t mtu = dev->getStreamMTU(stream);
+    mtu = std::clamp<size_t>(mtu, 1024, size_t(1) << 18);
+    sampleRing.reset(kSampleRingCapacity);
+    ringLogAccum = 0;
+    // the ring restarts empty; its first sample is the assembler's next
+    readerIndex = assembler.samplesIn();
+    gapRemaining = 0;
+    readerResync.store(true, std::memory_order_release);
+    clockSeeded = false;
+    deviceClock = false;
+    readerFailed.store(false, std::memory_order_release);
+    readerRunning.store(true, std::memory_order_release);
+    reader = QThread::create([this, mtu]() {
+      readerLoop(mtu);
+    });
+    reader->start(QThread::TimeCriticalPriority);
+    qInfo() << "[RX] Reader thread start MTU=" << mtu
+            << "ring=" << sampleRing.capacity();
+  }
+  void stopReader() {
+    if (!reader)
+      return;
+    readerRunning.store(false, std::memory_order_release);
+    reader->wait();
+    delete reader;
+    reader = nullptr;
+  }
+  // Losses are made good in place: every lost sample becomes a zero in the
+  // ring, written before the next real block, so stream indices keep
+  // counting device samples and captures keep their timing across a gap.
+  // Losses show up as driver overflows, as device timestamps that skip
+  // ahead, or as blocks the ring had no room for.
+  void readerLoop(size_t mtu) {
+    int pinnedCore = -2; // nothing applied yet; -1 is every CPU
+    std::vector<dsp::Cs8> block(mtu);
+    std::vector<int16_t> wide(streamCs16 ? 2 * mtu : 0);
+    const std::vector<dsp::Cs8> zeros(mtu);
+    bool haveNextTime = false;
+    long long nextTimeNs = 0; // device time the next block should carry
+    int errorRun = 0;         // hard errors in a row
+    while (readerRunning.load(std::memory_order_acquire)) {
+      // the DSP thread moves us when the device count changes
+      const int core = readerCore.load(std::memory_order_acquire);
+      if (core != pinnedCore) {
+        pinnedCore = core;
+        if (!pinCurrentThread(core >= 0 ? std::vector<int>{core}
+                                        : allCores()))
+          qWarning() << "[RX] Could not pin the reader thread";
+      }
+      // a retune restarts the device clock
+      if (readerResync.exchange(false, std::memory_order_acq_rel))
+        haveNextTime = false;
+      void *buffs[] = {streamCs16 ? static_cast<void *>(wide.data())
+                                  : static_cast<void *>(block.data())};
+      int flags = 0;
+      long long timeNs = 0;
+      int ret = dev->readStream(stream, buffs, block.size(), flags, timeNs,
+                                100'000);
+      if (ret > 0) {
+        errorRun = 0;
+        if (streamCs16) {
+          // full-scale CS16 keeps its top byte; an 8-bit ADC loses nothing
+          int8_t *dst = &block[0].re;
+          for (int i = 0; i < 2 * ret; ++i)
+            dst[i] = int8_t(wide[size_t(i)] >> 8);
+        }
+        const bool timed = (flags & SOAPY_SDR_HAS_TIME) != 0;
+        const double rxRate =
+            std::max(readerRate.load(std::memory_order_relaxed), 1.0);
+        if (timed && haveNextTime)
+          checkTimeJump(timeNs - nextTimeNs, rxRate);
+        // samples from before a retune settled are dropped outright, not
+        // zero-filled; the stream carries on from the first good one
+        size_t skip = 0;
+        if (settling.load(std::memory_order_acquire))
+          skip = settleSkip(timed, timeNs, size_t(ret), rxRate);
+        const size_t n = size_t(ret) - skip;
+        // zeros owed for earlier losses go in first
+        size_t stored = 0;
+        if (fillGap(zeros))
+          stored = sampleRing.write(block.data() + skip, n);
+        if (stored > 0 && (timed || !clockSeeded))
+          publishClock(flags,
+                       timeNs + std::llround(double(skip) * 1e9 / rxRate));
+        readerIndex += stored;
+        if (stored < n) {
+          readerCounters.dropped.fetch_add(n - stored,
+                                           std::memory_order_relaxed);
+          loseSamples(n - stored, StreamGap::Dropped);
+        }
+        if (timed) {
+          nextTimeNs = timeNs + std::llround(double(ret) * 1e9 / rxRate);
+          haveNextTime = true;
+        }
+        continue;
+      }
+      if (ret == SOAPY_SDR_TIMEOUT) {
+        readerCounters.timeouts.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      if (ret == SOAPY_SDR_OVERFLOW) {
+        readerCounters.overflows.fetch_add(1, std::memory_order_relaxed);
+        // with device time the next block says how much was lost;
+        // without it only the position is known
+        if (!haveNextTime)
+          postGap({readerIndex + gapRemaining, 0, StreamGap::Overflow});
+        continue;
+      }
+      // back off on hard errors; past kMaxReadErrors the device is
+      // taken to be gone and the watchdog reopens it
+      if (++errorRun >= kMaxReadErrors) {
+        qWarning() << "[RX] readStream keeps failing, error" << ret;
+        readerFailed.store(true, std::memory_order_release);
+        return;
+      }
+      QThread::msleep(1);
+    }
+  }
+  // Reader thread: how many leading samples of a block of n (the first
+  // at device time timeNs) were taken before the retune settled. Settling
+  // ends with the first block that reaches past it.
+  size_t settleSkip(bool timed, long long timeNs, size_t n, double rxRate) {
+    const long long untilNs = settleDeviceNs.load(std::memory_order_relaxed);
+    size_t skip = n;
+    if (timed && untilNs > 0) {
+      const double early = double(untilNs - timeNs) * rxRate * 1e-9;
+      skip = size_t(std::clamp(std::ceil(early), 0.0, double(n)));
+    } else if (monotonic.nsecsElapsed() >=
+               settleHostNs.load(std::memory_order_relaxed)) {
+      skip = 0;
+    }
+    readerCounters.settleDiscarded.fetch_add(skip, std::memory_order_relaxed);
+    if (skip < n) {
+      settling.store(false, std::memory_order_relaxed);
+      // zeros still owed go in ahead of the first kept sample
+      settledAt.store(readerIndex + gapRemaining + skip,
+                      std::memory_order_relaxed);
+      retuneLatencyNs.store(monotonic.nsecsElapsed() -
+                                retuneStartNs.load(std::memory_order_relaxed),
+                            std::memory_order_release);
+    }
+    return skip;
+  }
+  // Reader thread: compares a block's device time with where the previous
+  // block ended. Small skips are zero-filled; backwards steps and skips
+  // over kMaxGapFillSeconds are only reported, and the block's new clock
+  // anchor keeps UTC right from there on.
+  void checkTimeJump(long long deltaNs, double rxRate) {
+    const long long lost = std::llround(double(deltaNs) * rxRate * 1e-9);
+    if (std::llabs(lost) < kMinGapSamples)
+      return;
+    readerCounters.timeJumps.fetch_add(1, std::memory_order_relaxed);
+    if (lost < 0 || double(lost) > rxRate * kMaxGapFillSeconds) {
+      qWarning() << "[RX] Device time jumped" << deltaNs
+                 << "ns at stream index" << readerIndex + gapRemaining;
+      postGap({readerIndex + gapRemaining, 0, StreamGap::TimeJump});
+      return;
+    }
+    loseSamples(uint64_t(lost), StreamGap::TimeJump);
+  }
+  // Reader thread: owes n zeros at the current end of the stream.
+  void loseSamples(uint64_t n, StreamGap::Cause cause) {
+    if (gapRemaining == 0) {
+      gapStart = readerIndex;
+      gapTotal = 0;
+      gapCause = cause;
+    }
+    gapRemaining += n;
+    gapTotal += n;
+  }
+  // Reader thread: writes the zeros still owed, as far as the ring has
+  // room. True once none are left.
+  bool fillGap(const std::vector<dsp::Cs8> &zeros) {
+    while (gapRemaining > 0) {
+      const size_t room = sampleRing.capacity() - sampleRing.fillLevel();
+      const size_t n = size_t(
+          std::min<uint64_t>({gapRemaining, room, uint64_t(zeros.size())}));
+      if (n == 0)
+        return false;
+      sampleRing.write(zeros.data(), n);
+      readerIndex += n;
+      gapRemaining -= n;
+      readerCounters.zeroFilled.fetch_add(n, std::memory_order_relaxed);
+      if (gapRemaining == 0)
+        postGap({gapStart, gapTotal, gapCause});
+    }
+    return true;
+  }
+  void postGap(StreamGap gap) {
+    readerCounters.gaps.fetch_add(1, std::memory_order_relaxed);
+    if (!gapQueue.push(std::move(gap)))
+      qWarning() << "[RX] Gap queue full, gap record lost";
+  }
+  // DSP thread: logs the reader's gap records and keeps the recent ones
+  // for the capture metadata.
+  void drainGaps() {
+    StreamGap gap;
+    while (gapQueue.pop(gap))
+      noteGap(gap);
+  }
+  void noteGap(const StreamGap &gap) {
+    qWarning() << "[RX] Stream gap (" << StreamGap::causeName(gap.cause)
+               << ") at stream index" << gap.index << "samples="
+               << gap.samples << (gap.samples > 0 ? "zero-filled" : "");
+    recentGaps.push_back(gap);
+    if (recentGaps.size() > kMaxRecentGaps)
+      recentGaps.pop_front();
+    if (capturing)
+      manualGaps.push_back(gap);
+  }
+  // The gaps among `gaps` that fall inside a file of `count` samples whose
+  // sample 0 sits on stream position `start`, `step` stream samples
+  // apart, converted to file offsets.
+  static QVector<StreamGap> gapsInFile(const std::deque<StreamGap> &gaps,
+                                       double start, double step,
+                                       quint64 count) {
+    QVector<StreamGap> out;
+    const double end = start + double(count) * step;
+    for (const StreamGap &g : gaps) {
+      const double from = double(g.index);
+      const double to = from + double(g.samples);
+      if (to < start || from >= end)
+        continue;
+      StreamGap f = g;
+      f.index = quint64(std::floor((std::max(from, start) - start) / step));
+      if (g.samples > 0)
+        f.samples = std::max<quint64>(
+            1, quint64(std::ceil((std::min(to, end) - start) / step)) -
+                   f.index);
+      out.push_back(f);
+    }
+    return out;
+  }
+  void reportStreamStats(size_t got) {
+    statsSampleAccum += uint64_t(got);
+    statsTimerSamples += uint64_t(got);
+    if (statsSampleAccum < std::max<uint64_t>(uint64_t(rate), 1))
+      return;
+    statsSampleAccum = 0;
+    StreamStats s = streamStatsSnapshot();
+    const qint64 ns = statsTimer.isValid() ? statsTimer.nsecsElapsed() : 0;
+    if (ns > 0)
+      s.samplesPerSecond = double(statsTimerSamples) * 1e9 / double(ns);
+    statsTimer.start();
+    statsTimerSamples = 0;
+    emit streamStats(s);
+  }
+  StreamStats streamStatsSnapshot() const {
+    StreamStats s;
+    s.device = pipelineIndex;
+    s.serial = deviceInfo.serial;
+    s.sampleRate = rate;
+    s.ringFill = double(sampleRing.fillLevel()) /
+                 double(std::max<size_t>(sampleRing.capacity(), 1));
+    s.overflows = readerCounters.overflows.load(std::memory_order_relaxed);
+    s.timeouts = readerCounters.timeouts.load(std::memory_order_relaxed);
+    s.timeJumps = readerCounters.timeJumps.load(std::memory_order_relaxed);
+    s.droppedSamples = readerCounters.dropped.load(std::memory_order_relaxed);
+    s.zeroFilled = readerCounters.zeroFilled.load(std::memory_order_relaxed);
+    s.gaps = readerCounters.gaps.load(std::memory_order_relaxed);
+    s.restarts = restarts;
+    s.settleDiscarded =
+        readerCounters.settleDiscarded.load(std::memory_order_relaxed);
+    return s;
+  }
+  // Reader thread: anchors readerIndex to the block's device time, or to
+  // the host clock when the device gives none.
+  void publishClock(int flags, long long timeNs) {
+    const qint64 hostNs = QDateTime::currentMSecsSinceEpoch() * 1000000;
+    ClockAnchor &a = clockMailbox.writeBuffer();
+    a.index = readerIndex;
+    a.device = (flags & SOAPY_SDR_HAS_TIME) != 0;
+    if (a.device) {
+      if (!deviceClock) {
+        deviceOffsetNs = hostNs - timeNs;
+        deviceClock = true;
+      }
+      a.utcNs = timeNs + deviceOffsetNs;
+    } else {
+      a.utcNs = hostNs;
+    }
+    clockMailbox.publish();
+    clockSeeded = true;
+  }
+  // UTC (ns) of a stream position, counted from the newest anchor.
+  qint64 utcNsAt(double index) {
+    if (clockMailbox.fetch())
+      clock = clockMailbox.readBuffer();
+    return clock.utcNs + qint64(std::llround((index - double(clock.index)) *
+                                             1e9 / std::max(rate, 1.0)));
+  }
+  void logRingStats() {
+    // periodic ring occupancy report to help size the buffer
+    const uint64_t every = static_cast<uint64_t>(std::llround(rate * 5.0));
+    if (ringLogAccum < std::max<uint64_t>(every, 1))
+      return;
+    ringLogAccum = 0;
+    qInfo() << "[RX] Ring fill=" << sampleRing.fillLevel()
+            << "hwm=" << sampleRing.highWaterMark()
+            << "cap=" << sampleRing.capacity()
+            << "dropped=" << sampleRing.droppedSamples();
+    const StreamStats st = streamStatsSnapshot();
+    qInfo() << "[RX] Stream overflows=" << st.overflows
+            << "timeouts=" << st.timeouts << "timeJumps=" << st.timeJumps
+            << "gaps=" << st.gaps << "zeroFilled=" << st.zeroFilled;
+    const DiskWriter::Stats io = writer.stats();
+    qInfo() << "[IO] written=" << io.bytesWritten
+            << "dropped=" << io.bytesDropped
+            << "inFlight=" << io.buffersInFlight
+            << "peak=" << io.peakBuffersInFlight
+            << "errors=" << io.writeErrors;
+  }
+  // Retunes the device (when open) and resets what depends on the tuning.
+  // A gain change alone keeps the history and detectors.
   void applyTuning() {
-    if (!dev)
+    if (dev)
+      applyDeviceSettings();
+    // a new rate changes the hop plan
+    if (sweeping && rate != sweepRate)
+      restartSweep();
+    noiseFloorFresh = true;
+    if (freqHz == dspFreqHz && rate == dspRate)
       return;
-    dev->setSampleRate(SOAPY_SDR_RX, 0, rate);
-    dev->setFrequency(SOAPY_SDR_RX, 0, freqHz);
-    dev->setGainMode(SOAPY_SDR_RX, 0, false);
-    try {
-      dev->writeSetting("rtl_agc", "false");
-    } catch (...) {
+    dspFreqHz = freqHz;
+    dspRate = rate;
+    // samples from the old tuning are no use as pre-roll
+    history.clear();
+    ensureHistory();
+    configureChannelDetector();
+    configureChannels();
+  }
+  // Once per open: manual gain, and which gain element and AGC settings
+  // this driver has, so retunes only make calls that can succeed.
+  void setupControls() {
+    QStringList gains = deviceInfo.gainNames;
+    if (!deviceInfo.probed) {
+      for (const std::string &g : dev->listGains(SOAPY_SDR_RX, 0))
+        gains.push_back(QString::fromStdString(g));
     }
+    // a single element is set by name, several through the aggregate
+    gainElement = gains.size() == 1 ? gains.first().toStdString() : "";
     try {
-      dev->writeSetting("tuner_agc", "false");
-    } catch (...) {
+      dev->setGainMode(SOAPY_SDR_RX, 0, false);
+      for (const SoapySDR::ArgInfo &setting : dev->getSettingInfo()) {
+        if (setting.key == "rtl_agc" || setting.key == "tuner_agc")
+          dev->writeSetting(setting.key, "false");
+      }
+    } catch (const std::exception &e) {
+      qWarning() << "[RX] Could not disable AGC:" << e.what();
     }
-    // Try specific and aggregate gain controls to cover driver differences
+    // nothing is known to be set on a fresh device
+    devFreqHz = devRate = devGainDb = std::numeric_limits<double>::quiet_NaN();
+    qInfo() << "[RX] Gain control"
+            << (gainElement.empty() ? QString("aggregate")
+                                    : QString::fromStdString(gainElement));
+  }
+  // Pushes the tuning to the device, touching only what differs from what
+  // it was last set to. A new rate or frequency starts a settle: the
+  // reader drops what was taken before it and reports the latency.
+  void applyDeviceSettings() {
+    const bool newRate = rate != devRate;
+    const bool newFreq = freqHz != devFreqHz;
+    const bool newGain = gainDb != devGainDb;
+    if (!newRate && !newFreq && !newGain)
+      return;
+    const qint64 began = monotonic.nsecsElapsed();
     try {
-      dev->setGain(SOAPY_SDR_RX, 0, "LNA", gainDb);
-    } catch (...) {
+      if (newRate) {
+        readerRate.store(rate, std::memory_order_relaxed);
+        // the device clock may restart with the rate
+        readerResync.store(true, std::memory_order_release);
+        dev->setSampleRate(SOAPY_SDR_RX, 0, rate);
+        devRate = rate;
+      }
+      if (newFreq) {
+        dev->setFrequency(SOAPY_SDR_RX, 0, freqHz);
+        devFreqHz = freqHz;
+      }
+      if (newGain) {
+        if (gainElement.empty())
+          dev->setGain(SOAPY_SDR_RX, 0, gainDb);
+        else
+          dev->setGain(SOAPY_SDR_RX, 0, gainElement, gainDb);
+        devGainDb = gainDb;
+      }
+    } catch (const std::exception &e) {
+      qWarning() << "[RX] Retune failed:" << e.what();
     }
+    if (newRate || newFreq)
+      beginSettle(began);
+    if (!sweeping)
+      qInfo() << "[RX] Applied tuning" << "freq(MHz)=" << freqHz / 1e6
+              << "rate=" << rate << "gain(dB)=" << gainDb << "in"
+              << (monotonic.nsecsElapsed() - began) / 1000 << "us";
+    // the driver may pause the stream while it retunes
+    lastSamples.restart();
+  }
+  // Marks where the retune settles: kSettleSeconds past the device's
+  // current sample time, or past the host clock when the device keeps
+  // none.
+  void beginSettle(qint64 began) {
+    const qint64 settleNs = qint64(std::llround(kSettleSeconds * 1e9));
+    long long deviceNs = 0;
     try {
-      dev->setGain(SOAPY_SDR_RX, 0, "TUNER", gainDb);
+      deviceNs = dev->getHardwareTime();
     } catch (...) {
     }
-    try {
-      dev->setGain(SOAPY_SDR_RX, 0, gainDb);
-    } catch (...) {
+    settleDeviceNs.store(deviceNs > 0 ? deviceNs + settleNs : 0,
+                         std::memory_order_relaxed);
+    settleHostNs.store(monotonic.nsecsElapsed() + settleNs,
+                       std::memory_order_relaxed);
+    retuneStartNs.store(began, std::memory_order_relaxed);
+    // an earlier retune's report would say this one has settled
+    retuneLatencyNs.store(-1, std::memory_order_relaxed);
+    settling.store(true, std::memory_order_release);
+    settleBegun = true;
+  }
+  // DSP thread: reports a retune the reader has seen settle. Sweep hops
+  // only go into the sweep's statistics.
+  void reportRetune() {
+    const qint64 ns = retuneLatencyNs.exchange(-1, std::memory_order_acq_rel);
+    if (ns < 0)
+      return;
+    settledIndex = settledAt.load(std::memory_order_relaxed);
+    if (sweeping) {
+      hopSettled = true;
+      sweepSettleNs += ns;
+      return;
+    }
+    const double ms = double(ns) * 1e-6;
+    qInfo() << "[RX] Retune to" << freqHz / 1e6 << "MHz settled in" << ms
+            << "ms";
+    emit retuned(freqHz / 1e6, ms);
+  }
+  // Sweep mode. The LO hops across the range and every hop's flat centre
+  // goes into one stitched row; the display, triggers, history and
+  // channel plan pause until the sweep stops. Passes alternate up and
+  // down so the tuner never jumps back across the whole range, and each
+  // hop takes only kSweepFramesPerHop frames from its first settled
+  // sample on.
+  void startSweep(double startHz, double stopHz) {
+    if (!sweeping)
+      sweepHomeHz = freqHz;
+    sweeping = true;
+    sweepStartHz = startHz;
+    sweepStopHz = stopHz;
+    restartSweep();
+    qInfo() << "[RX] Sweep" << startHz / 1e6 << "-" << stopHz / 1e6
+            << "MHz," << stitcher.hops() << "hops of"
+            << (stitcher.stopHz() - stitcher.startHz()) / stitcher.hops() /
+                   1e6
+            << "MHz";
+  }
+  void stopSweep() {
+    if (!sweeping)
+      return;
+    sweeping = false;
+    freqHz = sweepHomeHz;
+    // history and detectors start over at the home frequency
+    dspFreqHz = std::numeric_limits<double>::quiet_NaN();
+    applyTuning();
+    qInfo() << "[RX] Sweep stopped, back to" << freqHz / 1e6 << "MHz";
+  }
+  void restartSweep() {
+    stitcher.configure(sweepStartHz, sweepStopHz, rate, activeFftSize,
+                       kSweepUsable);
+    sweepRate = rate;
+    sweepDir = 1;
+    sweepTimer.start();
+    sweepSettleNs = 0;
+    hopTo(0);
+  }
+  void hopTo(int hop) {
+    sweepHop = hop;
+    sweepFrames = 0;
+    sweepPower.assign(size_t(stitcher.fftSize()), 0.0f);
+    freqHz = stitcher.hopCenter(hop);
+    settleBegun = false;
+    if (dev)
+      applyDeviceSettings();
+    // frames count again once the reader has seen the tuner settle
+    hopSettled = !settleBegun;
+  }
+  // One transformed frame while sweeping; `end` is the stream index just
+  // past its last sample.
+  void sweepFrame(const fftwf_complex *out, uint64_t end) {
+    const int N = activeFftSize;
+    if (N != stitcher.fftSize()) {
+      restartSweep();
+      return;
+    }
+    if (!hopSettled || end < settledIndex + uint64_t(N))
+      return; // taken before this hop settled
+    const float ampScale = 1.0f / (float(N) * std::max(coherentGain, 1e-9f));
+    dsp::magnitude(out[0], ampScale, frameAmp.data(), N);
+    const int half = N / 2;
+    for (int i = 0; i < N; ++i) {
+      const float a = frameAmp[size_t((i + half) % N)];
+      sweepPower[size_t(i)] += a * a;
+    }
+    if (++sweepFrames < kSweepFramesPerHop)
+      return;
+    for (float &p : sweepPower)
+      p = std::sqrt(p / float(sweepFrames));
+    stitcher.add(sweepHop, sweepPower.data());
+    const int next = sweepHop + sweepDir;
+    if (next >= 0 && next < stitcher.hops()) {
+      hopTo(next);
+      return;
+    }
+    finishSweepPass();
+    // the next pass runs the other way from the hop we are on
+    sweepDir = -sweepDir;
+    hopTo(sweepHop);
+  }
+  void finishSweepPass() {
+    const std::vector<float> &row = stitcher.row();
+    QVector<float> out(int(row.size()));
+    for (size_t i = 0; i < row.size(); ++i)
+      out[int(i)] = std::min(row[i], 1.5f);
+    emit sweepRow(out, stitcher.startHz(), stitcher.stopHz());
+    stitcher.clear();
+    ++sweepPasses;
+    const qint64 ns = sweepTimer.nsecsElapsed();
+    if (ns < kSweepLogNs)
+      return;
+    const double seconds = double(ns) * 1e-9;
+    const double ghz =
+        (stitcher.stopHz() - stitcher.startHz()) * 1e-9 * sweepPasses;
+    const double hopCount = double(stitcher.hops()) * sweepPasses;
+    qInfo() << "[RX] Sweep rate" << ghz / seconds << "GHz/s,"
+            << sweepPasses / seconds << "rows/s, settle"
+            << double(sweepSettleNs) * 1e-6 / hopCount << "ms/hop";
+    sweepTimer.restart();
+    sweepPasses = 0;
+    sweepSettleNs = 0;
+  }
+  // Sizes the pre-trigger history for max(kHistorySeconds, preSeconds +
+  // dwellSeconds) at the current rate. Only reallocates when that grows.
+  void ensureHistory() {
+    // the pre-roll is taken before the start of the dwell
+    const double seconds =
+        std::max(kHistorySeconds, preSeconds + dwellSeconds);
+    const size_t need =
+        static_cast<size_t>(std::llround(rate * seconds)) + kHistorySlack;
+    if (need > history.capacity()) {
+      history.reset(need);
+      qInfo() << "[RX] Pre-trigger history" << need << "samples";
+    }
+  }
+  // Sets up the capture filters for the current rate, span and requested
+  // output rate. With a target rate the decimator stops at the largest
+  // integer factor that stays at or above it and the resampler covers the
+  // rest; without one the resampler passes through.
+  void configureCaptureChain() {
+    const double spanHalf = std::max(1.0, captureSpanHalfHz);
+    int D = Decimator::factorFor(rate, spanHalf);
+    if (captureRateHz > 0.0)
+      D = std::clamp(int(std::floor(rate / captureRateHz)), 1, D);
+    captureDecimator.configure(rate, spanHalf, D);
+    captureResampler.configure(captureDecimator.outputRate(),
+                               captureRateHz > 0.0
+                                   ? captureRateHz
+                                   : captureDecimator.outputRate(),
+                               spanHalf);
+  }
+  // Converts to float a block at a time on the way into the filters, so
+  // a long pre-roll never needs a float copy of its own.
+  void feedCapture(const dsp::Cs8 *in, size_t n) {
+    captureIq.resize(kReadChunk);
+    while (n > 0) {
+      const size_t count = std::min(n, kReadChunk);
+      dsp::cs8ToComplex(in, kIqScale, captureIq.data(), int(count));
+      captureStage.clear();
+      captureDecimator.process(captureIq.data(), count, captureStage);
+      captureResampler.process(captureStage.data(), captureStage.size(),
+                               captureBuffer);
+      in += count;
+      n -= count;
     }
-    qInfo() << "[RX] Applied tuning" << "freq(MHz)=" << freqHz / 1e6
-            << "rate=" << rate << "gain(dB)=" << gainDb;
   }
   void closeDevice() {
+    stopReader();
     if (dev) {
       if (stream) {
         dev->deactivateStream(stream);
@@ -627,36 +1888,44 @@ private:
       dev = nullptr;
     }
   }
+  // Pins this thread and the FFT helpers to cores[1..] and the reader to
+  // cores[0]; an empty set gives all of them every CPU back.
+  void applyCores() {
+    std::vector<int> dspCores(cores.size() > 1 ? cores.begin() + 1
+                                               : cores.begin(),
+                              cores.end());
+    if (dspCores.empty())
+      dspCores = allCores();
+    if (!pinCurrentThread(dspCores))
+      qWarning() << "[RX] Could not pin the DSP thread";
+    // unpinned, leave one core for the reader
+    const int fftThreads = cores.empty() ? int(dspCores.size()) - 1
+                                         : int(dspCores.size());
+    fft.setThreadCount(std::clamp(fftThreads, 1, 8));
+    fft.restartThreads();
+    readerCore.store(cores.empty() ? -1 : cores.front(),
+                     std::memory_order_release);
+  }
   void ensureFFTW(int N) {
-    if (sz == N)
-      return;
-    freeFFTW();
-    sz = N;
-    in = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * sz);
-    out = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * sz);
-    plan = fftwf_plan_dft_1d(sz, in, out, FFTW_FORWARD, FFTW_ESTIMATE);
-  }
-  void freeFFTW() {
-    if (plan)
-      fftwf_destroy_plan(plan);
-    if (in)
-      fftwf_free(in);
-    if (out)
-      fftwf_free(out);
-    plan = nullptr;
-    in = out = nullptr;
-    sz = 0;
-  }
-
-  // state
-  std::atomic<bool> running{false};
-  std::atomic<bool> capturing{false};
-  std::atomic<bool> reconfigureRequested{false};
-  std::atomic<bool> armed{false};
-  std::atomic<bool> inCapture{false};
-  std::atomic<double> triggerThresholdDb{-30.0};
-  std::atomic<double> captureSpanHalfHz{100000.0};
-  std::atomic<int> detectorMode{0}; // 0 averaged, 1 peak
+    // plans come from the process-wide cache, only batch buffers are ours
+    fft.configure(N, kMaxBatchFrames);
+    batchFresh.resize(size_t(kMaxBatchFrames) * size_t(N));
+    frameIq.resize(size_t(N));
+    batchFreshLen.resize(size_t(kMaxBatchFrames));
+    batchFreshIndex.resize(size_t(kMaxBatchFrames));
+    batchCount = 0;
+  }
+
+  // state; all of it is owned by the worker thread and only changed from
+  // drainCommands(), so none of it needs to be atomic
+  CommandQueue<RxCommand, 256> commands;
+  bool running{false};
+  bool capturing{false};
+  bool armed{false};
+  bool inCapture{false};
+  double triggerThresholdDb{-30.0};
+  double captureSpanHalfHz{100000.0};
+  int detectorMode{kDetectorAveraged};
   double preSeconds{0.2};
   double postSeconds{0.2};
   double dwellSeconds{0.02};
@@ -666,11 +1935,9 @@ private:
   // samples above threshold before starting capture.
 
   double avgTauSeconds{0.20};
-  uint64_t belowSamples{0};
   uint64_t totalSamplesSinceArm{0};
   uint64_t logSamplesAccum{0};
   double centerAvgLin{0.0};
-  uint64_t aboveStreakSamples{0};
   // periodic 'peak detected' logging while above threshold
   double peakLogSeconds{0.2};
   uint64_t peakLogAccum{0};
@@ -678,42 +1945,268 @@ private:
   double freqHz{433.81e6};
   double rate{2.6e6};
   double gainDb{40.0};
-  std::atomic<double> pendingFreqHz{433.81e6};
-  std::atomic<double> pendingRate{2.6e6};
-  std::atomic<double> pendingGain{40.0};
 
   SoapySDR::Device *dev{nullptr};
   SoapySDR::Stream *stream{nullptr};
 
-  // FFT
-  int sz{0};
-  fftwf_complex *in{nullptr}, *out{nullptr};
-  fftwf_plan plan{nullptr};
-  std::atomic<int> requestedFftSize{4096};
+  // Samples stay 8-bit (the RTL's native width) from the driver through the
+  // rings, frames and history; they only become float at the FFT and
+  // capture filter inputs. kIqScale maps full scale to 1.0.
+  static constexpr float kIqScale = 1.0f / 128.0f;
+  bool streamCs16{false}; // driver has no CS8; the reader narrows CS16
+  // Reader thread -> DSP thread sample handoff. 2^21 samples is ~0.65 s at
+  // 3.2 Msps, enough to ride out disk or GUI hiccups without overflowing.
+  static constexpr size_t kSampleRingCapacity = size_t(1) << 21;
+  SampleRing<dsp::Cs8> sampleRing;
+  QThread *reader{nullptr};
+  std::atomic<bool> readerRunning{false};
+  uint64_t ringLogAccum{0};
+  // stream losses: the reader zero-fills them and reports each as a
+  // StreamGap; totals are in readerCounters
+  static constexpr long long kMinGapSamples = 2; // timestamp jitter below
+  static constexpr double kMaxGapFillSeconds = 1.0;
+  static constexpr size_t kMaxRecentGaps = 256;
+  ReaderCounters readerCounters;
+  CommandQueue<StreamGap, 256> gapQueue; // reader -> DSP thread
+  std::atomic<double> readerRate{2.6e6};
+  std::atomic<bool> readerResync{true};
+  uint64_t gapStart{0};     // reader thread only
+  uint64_t gapRemaining{0}; // zeros still owed
+  uint64_t gapTotal{0};
+  StreamGap::Cause gapCause{StreamGap::Dropped};
+  std::deque<StreamGap> recentGaps; // DSP thread
+  std::deque<StreamGap> manualGaps; // during the manual capture
+  uint64_t statsSampleAccum{0};
+  uint64_t statsTimerSamples{0}; // since statsTimer started
+  QElapsedTimer statsTimer;
+  // stream watchdog (DSP thread), see superviseStream()
+  static constexpr qint64 kStallMs = 1000;
+  static constexpr qint64 kRetryMinMs = 50;
+  static constexpr qint64 kRetryMaxMs = 5000;
+  static constexpr int kMaxReadErrors = 50;
+  std::atomic<bool> readerFailed{false}; // reader gave up on errors
+  QElapsedTimer lastSamples; // since the ring last gave samples
+  QElapsedTimer outage;
+  QElapsedTimer retryTimer;
+  qint64 retryDelayMs{kRetryMinMs};
+  int retryAttempt{0};
+  bool degraded{false};
+  uint64_t restarts{0};
+  // Retuning. dev* is what the device was last set to (NaN: unknown),
+  // dsp* what the history and detectors are set up for. settle* and
+  // retune* pass a retune's settle point and latency through the reader.
+  static constexpr double kSettleSeconds = 0.005;
+  QElapsedTimer monotonic; // shared time base of both threads
+  std::string gainElement; // empty: aggregate gain
+  double devFreqHz{std::numeric_limits<double>::quiet_NaN()};
+  double devRate{std::numeric_limits<double>::quiet_NaN()};
+  double devGainDb{std::numeric_limits<double>::quiet_NaN()};
+  double dspFreqHz{std::numeric_limits<double>::quiet_NaN()};
+  double dspRate{std::numeric_limits<double>::quiet_NaN()};
+  std::atomic<bool> settling{false};
+  std::atomic<long long> settleDeviceNs{0}; // 0: device keeps no time
+  std::atomic<qint64> settleHostNs{0};
+  std::atomic<qint64> retuneStartNs{0};
+  std::atomic<qint64> retuneLatencyNs{-1};
+  std::atomic<uint64_t> settledAt{0}; // first stream index past the settle
+  uint64_t settledIndex{0};           // the same, on the DSP thread
+  bool settleBegun{false};            // set by beginSettle()
+  // sweep mode, see startSweep()
+  static constexpr double kSweepUsable = 0.75; // flat part of the passband
+  static constexpr int kSweepFramesPerHop = 2;
+  static constexpr qint64 kSweepLogNs = 5'000'000'000;
+  bool sweeping{false};
+  double sweepStartHz{0.0};
+  double sweepStopHz{0.0};
+  double sweepHomeHz{0.0}; // LO to return to
+  double sweepRate{0.0};   // the hop plan was made for
+  SpectrumStitcher stitcher;
+  std::vector<float> sweepPower; // this hop, FFT-shifted
+  int sweepHop{0};
+  int sweepDir{1};
+  int sweepFrames{0};
+  bool hopSettled{true};
+  QElapsedTimer sweepTimer;
+  int sweepPasses{0};
+  qint64 sweepSettleNs{0};
+  // DSP side: ring blocks -> contiguous FFT frames
+  static constexpr size_t kReadChunk = 16384;
+  FrameAssembler<dsp::Cs8> assembler;
+
+  // FFT: frames are transformed in batches of up to kMaxBatchFrames
+  static constexpr int kMaxBatchFrames = 32;
+  FftEngine fft;
+  std::vector<dsp::Cs8> batchFresh;
+  std::vector<std::complex<float>> frameIq; // float frame for the window
+  std::vector<int> batchFreshLen;
+  std::vector<uint64_t> batchFreshIndex; // stream index of each fresh run
+  int batchCount{0};
+  double fftOverlap{0.0};
+  int requestedFftSize{4096};
   int activeFftSize{4096};
+  std::vector<float> window;
+  std::vector<float> prevAmp;
+  std::vector<float> frameAmp; // raw amplitudes of the current frame
+  std::vector<float> amps;      // smoothed detector input
+  std::vector<float> ampsShift; // same, FFT-shifted
+  // FFT frame rate -> display rate
+  SpectrumAggregator aggregator;
+  double displayRateHz{60.0};
+  int displayMode{SpectrumAggregator::MaxHold};
+  uint64_t displaySampleAccum{0};
+  TripleBuffer<std::vector<float>> *mailbox; // owned by SDRReceiver
+  std::atomic<bool> *mailboxPending;
+  std::atomic<int> *captureClaim; // owned by SDRReceiver
+  int armGeneration{0};
+  bool statusAbove{false};
+  bool statusCapturing{false};
+  float coherentGain{1.0f}; // sum(w)/N for amplitude normalization
+  static constexpr float alpha = 0.4f; // smoothing factor, lower = more smoothing
 
-  QFile file;
+  // every capture file goes through the writer's I/O thread; it is declared
+  // before finalizePool so running CaptureJobs never outlive it
+  DiskWriter writer;
+  int fileHandle{-1};
+  CaptureResult manualInfo; // sidecar of the manual capture
   // live spooling while armed (for user feedback)
-  QFile spoolFile;
+  int spoolHandle{-1};
   QString spoolPath;
-  // Triggered capture buffers
-  std::vector<std::complex<float>> preBuffer; // ring buffer storage
-  uint64_t preBufferCap{0};
-  uint64_t preFilled{0};
-  uint64_t preHead{0}; // next position to overwrite
+  // Triggered capture buffers. The history ring records every frame, armed
+  // or not; kHistorySlack covers the current chunk on top of the pre-roll.
+  static constexpr double kHistorySeconds = 1.0;
+  static constexpr size_t kHistorySlack = 65536;
+  HistoryRing<dsp::Cs8> history;
+  // Capture chain: captureDecimator band-limits to the span and takes out
+  // the integer part of the rate change, captureResampler lands on the
+  // exact output rate. captureBuffer holds the result.
   std::vector<std::complex<float>> captureBuffer;
+  std::vector<std::complex<float>> captureIq;    // converted input block
+  std::vector<std::complex<float>> captureStage; // decimator -> resampler
+  Decimator captureDecimator;
+  Resampler captureResampler;
+  double captureRateHz{0.0}; // 0: whatever rate / D gives
+  // finished captures are handed to CaptureJobs; bumping the generation
+  // cancels the ones still pending
+  QThreadPool finalizePool;
+  std::atomic<unsigned> finalizeGeneration{0};
   QDateTime armStartTime;
   bool lastAbove{false};
+  double lastCenterDb{-120.0};
+  TriggerGate gate; // dwell / post-roll state of the armed trigger
+  // trigger edges and the capture's place in the stream (sample indices)
+  uint64_t streamIndex{0}; // first sample of the frame being processed
+  uint64_t triggerIndex{0};
+  uint64_t releaseIndex{0};
+  uint64_t captureFirstIndex{0};
+  double captureDelay{0.0}; // capture chain group delay, input samples
+  // released: the capture is recording its filter tail up to this index
+  bool captureReleased{false};
+  uint64_t captureEndIndex{0};
+  // stream clock: written by the reader, read back through the mailbox
+  TripleBuffer<ClockAnchor> clockMailbox;
+  ClockAnchor clock;
+  uint64_t readerIndex{0}; // reader thread only
+  qint64 deviceOffsetNs{0};
+  bool deviceClock{false};
+  bool clockSeeded{false};
+  // time-domain detector and its readings for the current frame
+  ChannelPowerDetector channelDetector;
+  bool channelDetectorFresh{true};
+  // CFAR threshold: per-bin noise over ~kCfarWindowSeconds of frames,
+  // read from reference bins beside the detection span
+  static constexpr double kCfarWindowSeconds = 0.5;
+  static constexpr int kCfarGuardBins = 4;
+  static constexpr int kCfarReferenceBins = 32;
+  int thresholdMode{kThresholdFixed};
+  double cfarMarginDb{10.0};
+  NoiseFloorEstimator noiseFloor;
+  bool noiseFloorFresh{true};
+  std::vector<float> framePower; // FFT-shifted |bin|^2 of the frame
+  double floorDb{-120.0};        // per bin, same scale as the display
+  double noiseBandwidth{1.5};    // of the window, in bins (Hann: 1.5)
+  std::vector<ChannelPowerDetector::Reading> detectorReadings;
+  SDRDeviceInfo deviceInfo; // from discovery; empty until it reports
+  int pipelineIndex{0};     // which of SDRReceiver's devices this is
+  std::vector<int> cores;   // see the constructor
+  std::atomic<int> readerCore{-1}; // -1: any CPU
+  // Channel plan. channelBase is the stream index of the first sample fed
+  // to the channelizer, channelSamples the outputs per channel since then;
+  // channel sample i is centred on stream sample
+  // channelBase + channelizer.delay() + i * channels.
+  ChannelPlan channelPlan;
+  Channelizer channelizer;
+  std::vector<ChannelTrigger> channelTriggers;
+  std::vector<std::vector<std::complex<float>>> channelOut;
+  std::vector<std::complex<float>> channelIq;
+  int channelWindow{1}; // channel samples per power reading
+  bool channelFresh{true};
+  uint64_t channelBase{0};
+  uint64_t channelSamples{0};
+  // bumped with the plan, so its captures still being written are dropped
+  std::atomic<unsigned> channelGeneration{0};
 
 signals:
-  void newFFTData(QVector<float> data);
-  void captureCompleted(QString filePath);
+  void spectrumReady(); // a new frame is in the receiver's mailbox
+  // both emitted from the finalize pool thread
+  void captureProgress(int percent);
+  void captureCompleted(const CaptureResult &result);
+  // stream health totals, about once a second
+  void streamStats(const StreamStats &stats);
+  // CFAR floor (per bin) and the threshold it gives, at display rate
+  void noiseFloorChanged(double floorDb, double thresholdDb);
+  void channelCaptureCompleted(int channel, const CaptureResult &result);
+  void streamDegraded(const QString &reason);
+  void streamRecovering(int attempt);
+  void streamRecovered(int outageMs);
+  // a retune's first settled sample arrived latencyMs after it began
+  void retuned(double freqMHz, double latencyMs);
+  void sweepRow(const QVector<float> &row, double startHz, double stopHz);
   void triggerStatus(bool armed, bool capturing, double centerDb,
                      double thresholdDb, bool above);
 };
 
+// One SDR's worker thread and its spectrum handoff, plus the newest
+// spectrum and trigger status it reported, for combining.
+struct SDRReceiver::Pipeline {
+  SDRDeviceInfo device; // empty: the first RTL-SDR that opens
+  int index{0};
+  QThread *thread{nullptr};
+  Worker *worker{nullptr};
+  // worker -> GUI spectrum handoff: newest frame wins, nothing queues up
+  TripleBuffer<std::vector<float>> mailbox;
+  std::atomic<bool> pending{false};
+  QVector<float> frame;
+  QElapsedTimer frameAge;
+  bool armed{false};
+  bool capturing{false};
+  bool above{false};
+  double centerDb{-120.0};
+  QElapsedTimer statusAge;
+
+  void post(RxCommand cmd) {
+    if (worker)
+      worker->post(std::move(cmd));
+  }
+};
+
+namespace {
+// another device's spectrum or trigger status older than this is left
+// out of the combined one
+constexpr qint64 kStaleMs = 500;
+
+bool sameDevice(const SDRDeviceInfo &a, const SDRDeviceInfo &b) {
+  if (!a.serial.isEmpty() || !b.serial.isEmpty())
+    return a.serial == b.serial;
+  return a.args == b.args;
+}
+} // namespace
+
 SDRReceiver::SDRReceiver(QObject *parent) : QObject(parent) {
   qRegisterMetaType<QVector<float>>("QVector<float>");
+  qRegisterMetaType<CaptureResult>("CaptureResult");
+  qRegisterMetaType<ChannelPlan>("ChannelPlan");
+  qRegisterMetaType<StreamStats>("StreamStats");
+  qRegisterMetaType<SDRDeviceInfo>("SDRDeviceInfo");
 }
 SDRReceiver::~SDRReceiver() { stopStream(); }
 
@@ -721,144 +2214,370 @@ void SDRReceiver::startStream(double freqMHz, double sampleRate) {
   lastFreqMHz = freqMHz;
   currentSampleRate = sampleRate;
   if (streaming) {
-    // Update immediately without relying on the worker event loop
-    if (worker)
-      worker->configureImmediate(freqMHz, sampleRate);
+    for (auto &p : pipelines)
+      p->post({RxCommand::Tune, freqMHz * 1e6, sampleRate});
     return;
   }
   streaming = true;
+  if (currentDevices.isEmpty()) {
+    startPipeline(SDRDeviceInfo());
+    return;
+  }
+  for (const SDRDeviceInfo &d : currentDevices)
+    startPipeline(d);
+}
 
-  thread = new QThread(this);
-  worker = new Worker(); // no parent before move
-  worker->moveToThread(thread);
+// Several SDRs get a share of the CPUs each, the reader on its own core;
+// a single one runs unpinned.
+std::vector<int> SDRReceiver::coresFor(int index) const {
+  const int count = std::max(int(currentDevices.size()), index + 1);
+  if (count < 2)
+    return {};
+  const int total = std::max(1, QThread::idealThreadCount());
+  const int per = std::max(2, total / count);
+  std::vector<int> cores;
+  for (int i = 0; i < per; ++i)
+    cores.push_back((index * per + i) % total);
+  return cores;
+}
 
-  connect(worker, &Worker::newFFTData, this, &SDRReceiver::newFFTData,
-          Qt::QueuedConnection);
+void SDRReceiver::startPipeline(const SDRDeviceInfo &device) {
+  auto owned = std::make_unique<Pipeline>();
+  Pipeline *p = owned.get();
+  p->device = device;
+  p->index = int(pipelines.size());
+  p->thread = new QThread(this);
+  p->worker = new Worker(&p->mailbox, &p->pending, &captureClaim,
+                         coresFor(p->index)); // no parent before move
+  p->worker->moveToThread(p->thread);
+  Worker *worker = p->worker;
+  const bool first = p->index == 0;
+
+  connect(
+      worker, &Worker::spectrumReady, this, [this, p]() { onSpectrumReady(p); },
+      Qt::QueuedConnection);
+  connect(
+      worker, &Worker::triggerStatus, this,
+      [this, p](bool armed, bool capturing, double centerDb,
+                double thresholdDb, bool above) {
+        onTriggerStatus(p, armed, capturing, centerDb, thresholdDb, above);
+      },
+      Qt::QueuedConnection);
+  connect(worker, &Worker::captureProgress, this,
+          &SDRReceiver::captureProgress, Qt::QueuedConnection);
   connect(worker, &Worker::captureCompleted, this,
           &SDRReceiver::captureCompleted, Qt::QueuedConnection);
-  connect(worker, &Worker::triggerStatus, this, &SDRReceiver::triggerStatus,
+  connect(worker, &Worker::streamStats, this, &SDRReceiver::streamStats,
           Qt::QueuedConnection);
-  connect(thread, &QThread::started, [=]() {
-    QMetaObject::invokeMethod(worker, "updateFftSize", Qt::QueuedConnection,
-                              Q_ARG(int, currentFftSize));
-    // Seed pending configuration for the worker loop to apply
-    worker->configureImmediate(freqMHz, sampleRate);
-    worker->setGain(currentGainDb);
-    QMetaObject::invokeMethod(worker, "startWork", Qt::QueuedConnection);
-  });
-  connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+  connect(worker, &Worker::streamDegraded, this, &SDRReceiver::streamDegraded,
+          Qt::QueuedConnection);
+  connect(worker, &Worker::streamRecovering, this,
+          &SDRReceiver::streamRecovering, Qt::QueuedConnection);
+  connect(worker, &Worker::streamRecovered, this,
+          &SDRReceiver::streamRecovered, Qt::QueuedConnection);
+  // the floor, retune timing, channel plan and sweep are the first
+  // device's alone
+  if (first) {
+    connect(worker, &Worker::noiseFloorChanged, this,
+            &SDRReceiver::noiseFloorChanged, Qt::QueuedConnection);
+    connect(worker, &Worker::channelCaptureCompleted, this,
+            &SDRReceiver::channelCaptureCompleted, Qt::QueuedConnection);
+    connect(worker, &Worker::retuned, this, &SDRReceiver::retuneCompleted,
+            Qt::QueuedConnection);
+    connect(worker, &Worker::sweepRow, this, &SDRReceiver::sweepRow,
+            Qt::QueuedConnection);
+  }
+  // Seed the current settings; the worker applies them before it opens
+  // the device.
+  worker->post({RxCommand::FftSize, currentFftSize});
+  worker->post({RxCommand::FftOverlap, currentFftOverlap});
+  worker->post({RxCommand::DisplayRate, currentDisplayRate});
+  worker->post({RxCommand::DisplayMode, currentDisplayMode});
+  worker->post({RxCommand::Threshold, currentThresholdDb});
+  worker->post({RxCommand::ThresholdMode, currentThresholdMode});
+  worker->post({RxCommand::CfarMargin, currentCfarMarginDb});
+  worker->post({RxCommand::CaptureSpan, currentCaptureSpanHz});
+  worker->post({RxCommand::CaptureRate, currentCaptureRateHz});
+  worker->post({RxCommand::DetectorMode, currentDetectorMode});
+  worker->post({RxCommand::Dwell, currentDwellSeconds});
+  worker->post({RxCommand::AvgTau, currentAvgTauSeconds});
+  assignDevice(p, device);
+  worker->post({RxCommand::Tune, lastFreqMHz * 1e6, currentSampleRate});
+  worker->post({RxCommand::Gain, currentGainDb});
+  pipelines.push_back(std::move(owned));
+  if (first) {
+    setChannelPlan(currentChannelPlan);
+    if (sweepStartMHz < sweepStopMHz)
+      startSweep(sweepStartMHz, sweepStopMHz);
+  }
+  connect(p->thread, &QThread::started, worker, &Worker::startWork);
+  connect(p->thread, &QThread::finished, worker, &QObject::deleteLater);
+
+  p->thread->start();
+  qInfo() << "[RX] Pipeline" << p->index << "for"
+          << (device.serial.isEmpty() ? QString("first RTL-SDR")
+                                      : "SN " + device.serial);
+}
+
+void SDRReceiver::assignDevice(Pipeline *p, const SDRDeviceInfo &device) {
+  p->device = device;
+  RxCommand cmd{RxCommand::Device, p->index};
+  cmd.device = std::make_shared<const SDRDeviceInfo>(device);
+  p->post(std::move(cmd));
+}
+
+void SDRReceiver::onSpectrumReady(Pipeline *p) {
+  // clear first so a frame published while we copy triggers a new wake-up
+  p->pending.store(false, std::memory_order_release);
+  if (!p->mailbox.fetch())
+    return;
+  const std::vector<float> &frame = p->mailbox.readBuffer();
+  p->frame.resize(int(frame.size()));
+  std::copy(frame.begin(), frame.end(), p->frame.begin());
+  p->frameAge.start();
+  // while the first device sweeps, the others are still tuned to the RX
+  // centre; their spectra would interleave with its sweepRow()s
+  if (sweepStartMHz < sweepStopMHz)
+    return;
+  // Several devices: one combined spectrum (per-bin max of the fresh
+  // ones), sent whenever the first fresh device delivers, so the display
+  // rate stays that of one device.
+  const Pipeline *lead = nullptr;
+  for (const auto &q : pipelines) {
+    if (q->frameAge.isValid() && q->frameAge.elapsed() < kStaleMs) {
+      lead = q.get();
+      break;
+    }
+  }
+  if (lead != p)
+    return;
+  // latestFrame is never shared (receivers copy out of it during the direct
+  // emit), so resizing and writing it do not reallocate
+  latestFrame.resize(p->frame.size());
+  std::copy(p->frame.begin(), p->frame.end(), latestFrame.begin());
+  for (const auto &q : pipelines) {
+    if (q.get() == p || q->frame.size() != latestFrame.size() ||
+        !q->frameAge.isValid() || q->frameAge.elapsed() >= kStaleMs)
+      continue;
+    dsp::maxHold(latestFrame.data(), q->frame.constData(),
+                 latestFrame.size());
+  }
+  emit newFFTData(latestFrame);
+}
 
-  thread->start();
+void SDRReceiver::onTriggerStatus(Pipeline *p, bool armed, bool capturing,
+                                  double centerDb, double thresholdDb,
+                                  bool above) {
+  p->armed = armed;
+  p->capturing = capturing;
+  p->above = above;
+  p->centerDb = centerDb;
+  p->statusAge.start();
+  for (const auto &q : pipelines) {
+    if (q.get() == p || !q->statusAge.isValid() ||
+        q->statusAge.elapsed() >= kStaleMs)
+      continue;
+    armed = armed || q->armed;
+    capturing = capturing || q->capturing;
+    above = above || q->above;
+    centerDb = std::max(centerDb, q->centerDb);
+  }
+  emit triggerStatus(armed, capturing, centerDb, thresholdDb, above);
 }
 
 void SDRReceiver::stopStream() {
   if (!streaming)
     return;
   streaming = false;
-  if (thread)
-    thread->requestInterruption();
-  if (worker) {
-    QMetaObject::invokeMethod(worker, "endCapture", Qt::QueuedConnection);
-    QMetaObject::invokeMethod(worker, "stopWork", Qt::QueuedConnection);
-  }
-  if (thread) {
-    thread->quit();
+  for (auto &p : pipelines) {
+    p->thread->requestInterruption();
+    p->post({RxCommand::EndCapture});
+    p->post({RxCommand::Stop});
+    p->thread->quit();
+  }
+  for (auto &p : pipelines) {
     // Wait for the worker to finish and the event loop to quit
-    if (!thread->wait(5000)) {
+    if (!p->thread->wait(5000)) {
       // Last resort to avoid dangling running thread on app shutdown
-      thread->terminate();
-      thread->wait(1000);
+      p->thread->terminate();
+      p->thread->wait(1000);
     }
-    delete thread;
-    thread = nullptr;
-    worker = nullptr;
+    delete p->thread;
   }
+  pipelines.clear();
 }
 
 void SDRReceiver::setFftSize(int size) {
   int clamped = std::clamp(size, 512, 8192);
   currentFftSize = clamped;
-  if (worker) {
-    QMetaObject::invokeMethod(worker, "updateFftSize", Qt::QueuedConnection,
-                              Q_ARG(int, clamped));
-  }
+  for (auto &p : pipelines)
+    p->post({RxCommand::FftSize, clamped});
+}
+
+void SDRReceiver::setFftOverlap(double fraction) {
+  currentFftOverlap = std::clamp(fraction, 0.0, 0.9);
+  for (auto &p : pipelines)
+    p->post({RxCommand::FftOverlap, currentFftOverlap});
+}
+
+void SDRReceiver::setDisplayRate(double fps) {
+  currentDisplayRate = std::clamp(fps, 0.1, 240.0);
+  for (auto &p : pipelines)
+    p->post({RxCommand::DisplayRate, currentDisplayRate});
+}
+
+void SDRReceiver::setDisplayMode(int mode) {
+  currentDisplayMode = mode;
+  for (auto &p : pipelines)
+    p->post({RxCommand::DisplayMode, mode});
 }
 
 void SDRReceiver::setGainDb(double gainDb) {
   currentGainDb = gainDb;
-  if (worker) {
-    QMetaObject::invokeMethod(worker, "setGain", Qt::QueuedConnection,
-                              Q_ARG(double, gainDb));
-  }
+  for (auto &p : pipelines)
+    p->post({RxCommand::Gain, gainDb});
 }
 
 void SDRReceiver::setSampleRate(double sampleRate) {
   currentSampleRate = sampleRate;
-  // If streaming, use existing immediate config pathway
-  if (streaming && worker) {
-    worker->configureImmediate(lastFreqMHz, sampleRate);
-  }
+  for (auto &p : pipelines)
+    p->post({RxCommand::Tune, lastFreqMHz * 1e6, sampleRate});
 }
 
 void SDRReceiver::startCapture(const QString &filePath) {
-  if (!streaming || !worker)
+  if (!streaming || pipelines.empty())
     return;
-  QMetaObject::invokeMethod(worker, "beginCapture", Qt::QueuedConnection,
-                            Q_ARG(QString, filePath));
+  RxCommand cmd{RxCommand::BeginCapture};
+  cmd.path = filePath;
+  pipelines.front()->post(std::move(cmd));
 }
 void SDRReceiver::stopCapture() {
-  if (!streaming || !worker)
+  if (!streaming || pipelines.empty())
     return;
-  QMetaObject::invokeMethod(worker, "endCapture", Qt::QueuedConnection);
+  pipelines.front()->post({RxCommand::EndCapture});
 }
 
 void SDRReceiver::setTriggerThresholdDb(double thresholdDb) {
-  if (worker) {
-    QMetaObject::invokeMethod(worker, "setThresholdDb", Qt::QueuedConnection,
-                              Q_ARG(double, thresholdDb));
-  }
+  currentThresholdDb = thresholdDb;
+  for (auto &p : pipelines)
+    p->post({RxCommand::Threshold, thresholdDb});
+}
+
+void SDRReceiver::setThresholdMode(int mode) {
+  currentThresholdMode = mode;
+  for (auto &p : pipelines)
+    p->post({RxCommand::ThresholdMode, mode});
+}
+
+void SDRReceiver::setCfarMarginDb(double db) {
+  currentCfarMarginDb = db;
+  for (auto &p : pipelines)
+    p->post({RxCommand::CfarMargin, db});
 }
 
 void SDRReceiver::setCaptureSpanHz(double halfSpanHz) {
-  if (worker) {
-    QMetaObject::invokeMethod(worker, "setCaptureSpanHzSlot",
-                              Qt::QueuedConnection, Q_ARG(double, halfSpanHz));
-  }
+  currentCaptureSpanHz = halfSpanHz;
+  for (auto &p : pipelines)
+    p->post({RxCommand::CaptureSpan, halfSpanHz});
+}
+
+void SDRReceiver::setCaptureOutputRate(double hz) {
+  currentCaptureRateHz = std::max(0.0, hz);
+  for (auto &p : pipelines)
+    p->post({RxCommand::CaptureRate, currentCaptureRateHz});
 }
 
 void SDRReceiver::setDetectorMode(int mode) {
-  if (worker) {
-    QMetaObject::invokeMethod(worker, "setDetectorModeSlot",
-                              Qt::QueuedConnection, Q_ARG(int, mode));
-  }
+  currentDetectorMode = mode;
+  for (auto &p : pipelines)
+    p->post({RxCommand::DetectorMode, mode});
 }
 
 void SDRReceiver::setDwellSeconds(double seconds) {
-  if (worker) {
-    QMetaObject::invokeMethod(worker, "setDwellSecondsSlot",
-                              Qt::QueuedConnection, Q_ARG(double, seconds));
-  }
+  currentDwellSeconds = seconds;
+  for (auto &p : pipelines)
+    p->post({RxCommand::Dwell, seconds});
 }
 
 void SDRReceiver::setAvgTauSeconds(double seconds) {
-  if (worker) {
-    QMetaObject::invokeMethod(worker, "setAvgTauSecondsSlot",
-                              Qt::QueuedConnection, Q_ARG(double, seconds));
-  }
+  currentAvgTauSeconds = seconds;
+  for (auto &p : pipelines)
+    p->post({RxCommand::AvgTau, seconds});
 }
 
 void SDRReceiver::armTriggeredCapture(double preSeconds, double postSeconds) {
-  if (!streaming || !worker)
+  if (!streaming)
+    return;
+  // the workers race for this arm's capture, see Worker::claimCapture()
+  RxCommand cmd{RxCommand::Arm, preSeconds, postSeconds};
+  cmd.n = ++armGeneration;
+  for (auto &p : pipelines)
+    p->post(cmd);
+}
+
+void SDRReceiver::startSweep(double startMHz, double stopMHz) {
+  sweepStartMHz = startMHz;
+  sweepStopMHz = stopMHz;
+  if (streaming && !pipelines.empty())
+    pipelines.front()->post({RxCommand::Sweep, startMHz * 1e6, stopMHz * 1e6});
+}
+
+void SDRReceiver::stopSweep() {
+  sweepStartMHz = sweepStopMHz = 0.0;
+  if (streaming && !pipelines.empty())
+    pipelines.front()->post({RxCommand::Sweep, 0.0, 0.0});
+}
+
+void SDRReceiver::setDevices(const QVector<SDRDeviceInfo> &devices) {
+  currentDevices = devices;
+  if (!streaming)
+    return;
+  // Devices that appear get a pipeline of their own; ones that go away
+  // keep theirs, whose watchdog picks the device up again on replug.
+  for (const SDRDeviceInfo &d : devices) {
+    const auto known =
+        std::find_if(pipelines.begin(), pipelines.end(),
+                     [&d](const std::unique_ptr<Pipeline> &p) {
+                       return sameDevice(p->device, d);
+                     });
+    if (known != pipelines.end())
+      continue;
+    // a pipeline started before discovery reported opened the first
+    // RTL-SDR it found; it takes this one and reopens its stream on it,
+    // so the others never share a dongle with it
+    if (pipelines.size() == 1 && pipelines.front()->device.args.isEmpty()) {
+      assignDevice(pipelines.front().get(), d);
+      continue;
+    }
+    startPipeline(d);
+  }
+  pinPipelines();
+}
+
+// The CPU shares depend on how many devices there are, so every pipeline
+// moves when that changes.
+void SDRReceiver::pinPipelines() {
+  for (auto &p : pipelines) {
+    RxCommand cmd{RxCommand::Cores};
+    cmd.cores = std::make_shared<const std::vector<int>>(coresFor(p->index));
+    p->post(std::move(cmd));
+  }
+}
+
+void SDRReceiver::setChannelPlan(const ChannelPlan &plan) {
+  currentChannelPlan = plan;
+  if (pipelines.empty())
     return;
-  QMetaObject::invokeMethod(worker, "armCapture", Qt::QueuedConnection,
-                            Q_ARG(double, preSeconds),
-                            Q_ARG(double, postSeconds));
+  RxCommand cmd{RxCommand::Channels};
+  cmd.plan = std::make_shared<const ChannelPlan>(plan);
+  pipelines.front()->post(std::move(cmd));
 }
 
 void SDRReceiver::cancelTriggeredCapture() {
-  if (!streaming || !worker)
+  if (!streaming)
     return;
-  QMetaObject::invokeMethod(worker, "cancelCapture", Qt::QueuedConnection);
+  for (auto &p : pipelines)
+    p->post({RxCommand::Cancel});
 }
 
 #include "SDRReceiver.moc"
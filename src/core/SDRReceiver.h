@@ -1,9 +1,16 @@
 
 #pragma once
+#include "CaptureResult.h"
+#include "ChannelPlan.h"
+#include "SDRDeviceInfo.h"
+#include "StreamStats.h"
 #include <QFile>
 #include <QObject>
 #include <QThread>
 #include <QVector>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 class SDRReceiver : public QObject {
   Q_OBJECT
@@ -11,39 +18,121 @@ public:
   explicit SDRReceiver(QObject *parent = nullptr);
   ~SDRReceiver();
 
+  // RTL-SDRs discovery found, with the capabilities it probed (trusted
+  // instead of asking each device again). Every device streams on a
+  // worker of its own, all tuned alike; newFFTData and triggerStatus
+  // combine them and streamStats comes per device. A device that goes
+  // away keeps its worker, which reopens it if it comes back.
+  void setDevices(const QVector<SDRDeviceInfo> &devices);
   // starts the RX thread and keeps it running until app exit or stopStream()
   void startStream(double freqMHz, double sampleRate = 2.6e6);
   void stopStream(); // only used on app shutdown
   void setFftSize(int size);
+  // fraction of each FFT frame shared with the previous one (0..0.9)
+  void setFftOverlap(double fraction);
+  // newFFTData is emitted at most `fps` times per second (0.1..240); the
+  // frames in between are folded in by max-hold (0) or power average (1)
+  void setDisplayRate(double fps);
+  void setDisplayMode(int mode);
   void setGainDb(double gainDb);
   void setSampleRate(double sampleRate);
   void setTriggerThresholdDb(double thresholdDb);
+  // 0 = Fixed (setTriggerThresholdDb), 1 = CA-CFAR, 2 = OS-CFAR: the
+  // threshold follows the noise floor beside the span, `margin` dB above
+  void setThresholdMode(int mode);
+  void setCfarMarginDb(double db);
   void setCaptureSpanHz(double halfSpanHz); // detection half-span around RX
-  // 0 = Averaged detector, 1 = Peak detector
+  // exact sample rate of written captures; 0 keeps rate / D, the largest
+  // integer decimation that still covers the span with a guard band
+  void setCaptureOutputRate(double hz);
+  // 0 = Averaged detector, 1 = Peak detector (both on the FFT bins),
+  // 2 = Channel power: time-domain power over ~20 us windows in the span
   void setDetectorMode(int mode);
   void setDwellSeconds(double seconds);
   void setAvgTauSeconds(double seconds);
   void armTriggeredCapture(double preSeconds = 0.2, double postSeconds = 0.2);
+  // Watches several channels of the band at once, independently of the
+  // armed trigger above; replaces the previous plan and abandons its
+  // captures still in progress.
+  void setChannelPlan(const ChannelPlan &plan);
   void cancelTriggeredCapture();
+  // Sweep mode: hops the first device's LO across startMHz..stopMHz and
+  // emits stitched sweepRow()s in place of newFFTData, from every device.
+  // Its triggers and channels pause; other devices keep theirs.
+  void startSweep(double startMHz, double stopMHz);
+  void stopSweep();
 
 public slots:
   // toggles capture without stopping the stream
-  void startCapture(const QString &filePath); // writes CF32 interleaved
+  // writes the raw stream: CS8 interleaved, full scale = 128
+  void startCapture(const QString &filePath);
   void stopCapture();
 
 signals:
-  void newFFTData(QVector<float> data);
-  void captureCompleted(QString filePath);
+  // Emitted on the GUI thread with the newest spectrum only; connect with
+  // Qt::DirectConnection and copy what you need, the vector is reused.
+  void newFFTData(const QVector<float> &data);
+  // a triggered capture has ended and is being written out (0..100)
+  void captureProgress(int percent);
+  void captureCompleted(const CaptureResult &result);
+  // overflow / timeout / gap totals and throughput of each device's RX
+  // stream (StreamStats::device), about once a second
+  void streamStats(const StreamStats &stats);
+  // CFAR only: the estimated floor per FFT bin and the threshold in use
+  void noiseFloorChanged(double floorDb, double thresholdDb);
+  // a channel of the ChannelPlan has written a capture
+  void channelCaptureCompleted(int channel, const CaptureResult &result);
+  // Stream watchdog: the device stopped delivering (or never opened) and
+  // is being reopened with backoff; the spectrum, history and trigger
+  // settings survive the restart.
+  void streamDegraded(const QString &reason);
+  void streamRecovering(int attempt);
+  void streamRecovered(int outageMs);
+  // Time from a retune being applied to its first settled sample. Only
+  // what changed is sent to the device, and samples taken before the
+  // tuner settled are dropped.
+  void retuneCompleted(double freqMHz, double latencyMs);
+  // one pass of the sweep: amplitudes (full scale 1) from startHz to
+  // stopHz, evenly spaced
+  void sweepRow(const QVector<float> &row, double startHz, double stopHz);
   void triggerStatus(bool armed, bool capturing, double centerDb,
                      double thresholdDb, bool above);
 
 private:
   class Worker;
-  QThread *thread{nullptr};
-  Worker *worker{nullptr};
+  struct Pipeline;
+  void startPipeline(const SDRDeviceInfo &device);
+  void assignDevice(Pipeline *p, const SDRDeviceInfo &device);
+  std::vector<int> coresFor(int index) const;
+  void pinPipelines();
+  void onSpectrumReady(Pipeline *p);
+  void onTriggerStatus(Pipeline *p, bool armed, bool capturing,
+                       double centerDb, double thresholdDb, bool above);
+
+  std::vector<std::unique_ptr<Pipeline>> pipelines;
+  // arms so far, and the newest one a device has taken the capture of
+  int armGeneration{0};
+  std::atomic<int> captureClaim{0};
   bool streaming{false};
   int currentFftSize{4096};
+  double currentFftOverlap{0.0};
+  double currentDisplayRate{60.0};
+  int currentDisplayMode{0};
   double currentGainDb{40.0};
   double currentSampleRate{2.6e6};
   double lastFreqMHz{433.81};
+  // trigger settings, replayed to each new worker
+  double currentThresholdDb{-30.0};
+  int currentThresholdMode{0};
+  double currentCfarMarginDb{10.0};
+  double currentCaptureSpanHz{100000.0};
+  double currentCaptureRateHz{0.0};
+  int currentDetectorMode{0};
+  double currentDwellSeconds{0.02};
+  double currentAvgTauSeconds{0.20};
+  ChannelPlan currentChannelPlan;
+  QVector<SDRDeviceInfo> currentDevices;
+  double sweepStartMHz{0.0}; // equal to sweepStopMHz: not sweeping
+  double sweepStopMHz{0.0};
+  QVector<float> latestFrame; // combined spectrum
 };
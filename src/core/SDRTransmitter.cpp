@@ -1,4 +1,5 @@
 #include "SDRTransmitter.h"
+#include "FftPlanCache.h"
 #include <QCoreApplication>
 #include <QDebug>
 #include <SoapySDR/Device.hpp>
@@ -56,15 +57,18 @@ public slots:
     size_t wavePos = 0;
     double waveFs = 0.0;
     double waveHalfSpan = 0.0;
+    const int Nwave = 1 << 18; // 262144 samples ~0.1s at 2.6 Msps
+    // IFFT scratch, fftwf_malloc'd to match the alignment of the cached plan
+    fftwf_complex *freqBins =
+        (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * Nwave);
+    fftwf_complex *timeBuf =
+        (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * Nwave);
+    const FftPlan *wavePlan =
+        FftPlanCache::instance().acquire(Nwave, FFTW_BACKWARD);
     auto rebuildWave = [&](double fs, double halfSpan) {
       // Build a large block of band-limited noise in frequency domain and IFFT
-      int Nwave = 1 << 18; // 262144 samples ~0.1s at 2.6 Msps
       if (waveN != Nwave)
         wave.resize(Nwave);
-      std::vector<fftwf_complex> freqBins(Nwave);
-      std::vector<fftwf_complex> timeBuf(Nwave);
-      fftwf_plan plan = fftwf_plan_dft_1d(Nwave, freqBins.data(), timeBuf.data(),
-                                          FFTW_BACKWARD, FFTW_ESTIMATE);
       // Clear bins
       for (int k = 0; k < Nwave; ++k) {
         freqBins[k][0] = 0.0f;
@@ -86,8 +90,7 @@ public slots:
         freqBins[k][0] = norm(rng);
         freqBins[k][1] = norm(rng);
       }
-      fftwf_execute(plan);
-      fftwf_destroy_plan(plan);
+      fftwf_execute_dft(wavePlan->get(), freqBins, timeBuf);
       // Normalize RMS magnitude to 1.0 and copy to wave
       double acc = 0.0;
       const float invNwave = 1.0f / float(Nwave);
@@ -164,7 +167,8 @@ public slots:
 
     dev->deactivateStream(stream);
     qInfo() << "[TX] Stream deactivated";
-    // no FFT resources to free
+    fftwf_free(freqBins);
+    fftwf_free(timeBuf);
   }
 
   void stopWork() { running.store(false, std::memory_order_release); }
@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Lock-free single-producer/single-consumer ring for raw IQ samples.
+// Storage is allocated once up front; the producer never blocks and drops
+// (and counts) whatever does not fit so the device can always be drained.
+template <typename T> class SampleRing {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SampleRing stores plain sample types only");
+
+public:
+  explicit SampleRing(size_t capacity = 0) { reset(capacity); }
+
+  // Not thread-safe: only call while neither side is running.
+  void reset(size_t capacity) {
+    size_t cap = 1;
+    while (cap < capacity)
+      cap <<= 1;
+    storage.assign(capacity > 0 ? cap : 0, T{});
+    mask = storage.empty() ? 0 : storage.size() - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    highWater.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return storage.size(); }
+  // Samples written but not yet consumed
+  size_t fillLevel() const {
+    return size_t(head.load(std::memory_order_acquire) -
+                  tail.load(std::memory_order_acquire));
+  }
+  size_t highWaterMark() const {
+    return highWater.load(std::memory_order_relaxed);
+  }
+  uint64_t droppedSamples() const {
+    return dropped.load(std::memory_order_relaxed);
+  }
+  void resetHighWaterMark() {
+    highWater.store(fillLevel(), std::memory_order_relaxed);
+  }
+
+  // Producer side. Returns the number of samples stored; the rest is dropped.
+  size_t write(const T *src, size_t n) {
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    const uint64_t t = tail.load(std::memory_order_acquire);
+    const size_t used = size_t(h - t);
+    const size_t room = storage.size() - used;
+    const size_t count = std::min(n, room);
+    if (count < n)
+      dropped.fetch_add(uint64_t(n - count), std::memory_order_relaxed);
+    if (count == 0)
+      return 0;
+    copyIn(size_t(h & mask), src, count);
+    head.store(h + count, std::memory_order_release);
+    const size_t level = used + count;
+    if (level > highWater.load(std::memory_order_relaxed))
+      highWater.store(level, std::memory_order_relaxed);
+    return count;
+  }
+
+  // Consumer side.
+  size_t available() const {
+    return size_t(head.load(std::memory_order_acquire) -
+                  tail.load(std::memory_order_relaxed));
+  }
+  size_t read(T *dst, size_t n) {
+    const uint64_t t = tail.load(std::memory_order_relaxed);
+    const uint64_t h = head.load(std::memory_order_acquire);
+    const size_t count = std::min(n, size_t(h - t));
+    if (count == 0)
+      return 0;
+    copyOut(dst, size_t(t & mask), count);
+    tail.store(t + count, std::memory_order_release);
+    return count;
+  }
+
+private:
+  void copyIn(size_t pos, const T *src, size_t n) {
+    const size_t first = std::min(n, storage.size() - pos);
+    std::memcpy(storage.data() + pos, src, first * sizeof(T));
+    if (n > first)
+      std::memcpy(storage.data(), src + first, (n - first) * sizeof(T));
+  }
+  void copyOut(T *dst, size_t pos, size_t n) const {
+    const size_t first = std::min(n, storage.size() - pos);
+    std::memcpy(dst, storage.data() + pos, first * sizeof(T));
+    if (n > first)
+      std::memcpy(dst + first, storage.data(), (n - first) * sizeof(T));
+  }
+
+  std::vector<T> storage;
+  size_t mask{0};
+  // producer and consumer indices live on separate cache lines
+  alignas(64) std::atomic<uint64_t> head{0};
+  alignas(64) std::atomic<uint64_t> tail{0};
+  alignas(64) std::atomic<size_t> highWater{0};
+  std::atomic<uint64_t> dropped{0};
+};
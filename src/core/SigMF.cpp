@@ -0,0 +1,121 @@
+#include "SigMF.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+QString isoTime(qint64 utcNs) {
+  // SigMF wants ISO-8601 UTC; keep the nanoseconds Qt would round off
+  const QDateTime t = QDateTime::fromMSecsSinceEpoch(utcNs / 1000000).toUTC();
+  return t.toString("yyyy-MM-ddTHH:mm:ss.zzz") +
+         QString("%1Z").arg(utcNs % 1000000, 6, 10, QChar('0'));
+}
+
+qint64 bytesPerSample(const QString &datatype) {
+  if (datatype.startsWith("cf32"))
+    return 8;
+  if (datatype.startsWith("ci16"))
+    return 4;
+  return 2; // ci8
+}
+} // namespace
+
+namespace sigmf {
+
+QString metaPathFor(const QString &dataPath) {
+  const QFileInfo info(dataPath);
+  return info.path() + "/" + info.completeBaseName() + ".sigmf-meta";
+}
+
+bool writeMeta(const CaptureResult &r) {
+  const double step = r.sampleRate > 0.0 ? r.inputRate / r.sampleRate : 0.0;
+  const double nsPerSample = r.sampleRate > 0.0 ? 1e9 / r.sampleRate : 0.0;
+
+  QJsonObject global;
+  global["core:version"] = "1.0.0";
+  global["core:datatype"] = r.datatype;
+  global["core:sample_rate"] = r.sampleRate;
+  global["core:recorder"] = "DualityRF";
+  global["core:dataset"] = QFileInfo(r.filePath).fileName();
+  global["core:num_channels"] = 1;
+  if (!r.device.isEmpty())
+    global["core:hw"] = r.device;
+  global["duality:gain_db"] = r.gainDb;
+  global["duality:input_rate"] = r.inputRate;
+  global["duality:decimation"] = r.decimation;
+  global["duality:resample"] = QJsonArray{r.resampleUp, r.resampleDown};
+  global["duality:start_sample"] = r.startSample;
+  if (r.armTimeNs > 0)
+    global["duality:armed"] = isoTime(r.armTimeNs);
+
+  // one row per segment: [file sample, byte offset, stream sample, UTC ns]
+  // so a reader can seek by time or stream position without a scan
+  QJsonArray segments;
+  const qint64 stride = bytesPerSample(r.datatype);
+  for (quint64 s = 0; s < std::max<quint64>(r.samples, 1);
+       s += kIndexSegmentSamples) {
+    segments.append(QJsonArray{
+        double(s), double(qint64(s) * stride),
+        double(std::llround(r.startSample + double(s) * step)),
+        double(r.startTimeNs + qint64(std::llround(double(s) * nsPerSample)))});
+  }
+  QJsonObject index;
+  index["segment_samples"] = double(kIndexSegmentSamples);
+  index["bytes_per_sample"] = double(stride);
+  index["segments"] = segments;
+  global["duality:index"] = index;
+
+  QJsonObject capture;
+  capture["core:sample_start"] = 0;
+  capture["core:frequency"] = r.centerHz;
+  capture["core:datetime"] = isoTime(r.startTimeNs);
+
+  QJsonArray annotations;
+  if (r.releaseSample > r.triggerSample) {
+    QJsonObject trigger;
+    trigger["core:sample_start"] = double(r.triggerOffset);
+    trigger["core:sample_count"] =
+        double(r.releaseOffset > r.triggerOffset
+                   ? r.releaseOffset - r.triggerOffset
+                   : 0);
+    trigger["core:label"] = "trigger";
+    trigger["duality:trigger_sample"] = double(r.triggerSample);
+    trigger["duality:release_sample"] = double(r.releaseSample);
+    trigger["duality:trigger_time"] = isoTime(r.triggerTimeNs);
+    trigger["duality:release_time"] = isoTime(r.releaseTimeNs);
+    annotations.append(trigger);
+  }
+  for (const StreamGap &g : r.gaps) {
+    QJsonObject gap;
+    gap["core:sample_start"] = double(g.index);
+    gap["core:sample_count"] = double(g.samples);
+    gap["core:label"] = "gap";
+    gap["core:comment"] =
+        g.samples > 0 ? "zero-filled: " + StreamGap::causeName(g.cause)
+                      : StreamGap::causeName(g.cause) + ", length unknown";
+    annotations.append(gap);
+  }
+
+  QJsonObject root;
+  root["global"] = global;
+  root["captures"] = QJsonArray{capture};
+  root["annotations"] = annotations;
+
+  const QString path = metaPathFor(r.filePath);
+  QSaveFile f(path);
+  if (!f.open(QIODevice::WriteOnly) ||
+      f.write(QJsonDocument(root).toJson(QJsonDocument::Indented)) < 0 ||
+      !f.commit()) {
+    qWarning() << "[RX] SigMF sidecar write failed ->" << path;
+    return false;
+  }
+  return true;
+}
+
+} // namespace sigmf
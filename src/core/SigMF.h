@@ -0,0 +1,17 @@
+#pragma once
+#include "CaptureResult.h"
+#include <QString>
+
+// SigMF-style metadata sidecars. Every capture file gets a JSON
+// `<name>.sigmf-meta` next to it: the SigMF core fields (datatype, rate,
+// centre frequency, UTC start, trigger annotation) plus a `duality:`
+// namespace with the receiver settings and a compact segment index. The
+// data keeps its own extension; `core:dataset` names it.
+namespace sigmf {
+// output samples per entry of the segment index
+constexpr quint64 kIndexSegmentSamples = quint64(1) << 20;
+
+QString metaPathFor(const QString &dataPath);
+// Writes the sidecar for r.filePath; false (and a warning) on I/O errors.
+bool writeMeta(const CaptureResult &r);
+} // namespace sigmf
@@ -0,0 +1,65 @@
+#pragma once
+#include "DspKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Reduces the FFT frames that fall between two display refreshes to one
+// spectrum, so the UI sees every burst without receiving every frame.
+// Inputs and output are linear amplitudes.
+class SpectrumAggregator {
+public:
+  enum Mode {
+    MaxHold = 0,      // per-bin maximum: short bursts stay visible
+    PowerAverage = 1, // per-bin mean power: steadier noise floor
+  };
+
+  void reset(int bins) {
+    acc.assign(size_t(std::max(bins, 0)), 0.0f);
+    count = 0;
+  }
+  void setMode(Mode m) {
+    if (m != mode) {
+      mode = m;
+      reset(int(acc.size()));
+    }
+  }
+  int bins() const { return int(acc.size()); }
+  int frames() const { return count; }
+
+  void add(const float *amps, int n) {
+    if (n != int(acc.size()))
+      reset(n);
+    if (mode == MaxHold) {
+      dsp::maxHold(acc.data(), amps, n);
+    } else {
+      for (int i = 0; i < n; ++i)
+        acc[size_t(i)] += amps[i] * amps[i];
+    }
+    ++count;
+  }
+
+  // Writes the aggregate of the frames added since the last take() to
+  // out[0..bins()) and starts a new interval.
+  void take(float *out) {
+    const int n = int(acc.size());
+    if (count == 0) {
+      std::fill(out, out + n, 0.0f);
+      return;
+    }
+    if (mode == MaxHold) {
+      std::copy(acc.begin(), acc.end(), out);
+    } else {
+      const float inv = 1.0f / float(count);
+      for (int i = 0; i < n; ++i)
+        out[i] = std::sqrt(acc[size_t(i)] * inv);
+    }
+    std::fill(acc.begin(), acc.end(), 0.0f);
+    count = 0;
+  }
+
+private:
+  std::vector<float> acc;
+  int count{0};
+  Mode mode{MaxHold};
+};
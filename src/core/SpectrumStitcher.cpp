@@ -0,0 +1,41 @@
+#include "SpectrumStitcher.h"
+#include <algorithm>
+#include <cmath>
+
+void SpectrumStitcher::configure(double startHz, double stopHz, double rate,
+                                 int fftSize, double usableFraction,
+                                 int maxBins) {
+  N = std::max(fftSize, 2 * (kDcBins + 2));
+  binHz = rate / double(N);
+  keep = std::clamp(int(usableFraction * double(N) * 0.5), kDcBins + 2,
+                    N / 2);
+  hopWidth = 2.0 * double(keep) * binHz;
+  rangeStart = startHz;
+  const double span = std::max(stopHz - startHz, hopWidth);
+  hopCount = std::max(1, int(std::ceil(span / hopWidth - 1e-9)));
+  const double covered = double(hopCount) * hopWidth;
+  rowBinHz = std::max(binHz, covered / double(std::max(maxBins, 1)));
+  bins.assign(size_t(std::ceil(covered / rowBinHz - 1e-6)), 0.0f);
+}
+
+void SpectrumStitcher::clear() { std::fill(bins.begin(), bins.end(), 0.0f); }
+
+void SpectrumStitcher::add(int hop, const float *amps) {
+  if (hop < 0 || hop >= hopCount)
+    return;
+  const int half = N / 2;
+  // the DC spike is bridged with the mean of the bins beside it
+  const float dcFill =
+      0.5f * (amps[half - kDcBins - 1] + amps[half + kDcBins + 1]);
+  // bin i sits at hopCenter + (i - half) * binHz; the first kept bin of
+  // hop h lands exactly on startHz + h * hopWidth
+  const double first = double(hop) * hopWidth / rowBinHz;
+  const double step = binHz / rowBinHz;
+  const int last = int(bins.size()) - 1;
+  for (int i = half - keep; i < half + keep; ++i) {
+    const float v = std::abs(i - half) <= kDcBins ? dcFill : amps[i];
+    const int k = std::min(
+        last, int(first + double(i - half + keep) * step + 1e-6));
+    bins[size_t(k)] = std::max(bins[size_t(k)], v);
+  }
+}
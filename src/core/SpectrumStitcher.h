@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+
+// Builds one wide spectrum row out of LO hops. Each hop keeps only the
+// flat centre of its FFT (usableFraction of the sample rate), with the
+// bins around the DC spike filled in from their neighbours. Hop centres
+// are spaced by exactly that width, so the kept pieces tile startHz..
+// stopHz edge to edge; they are folded by max into a row of at most
+// maxBins bins, which keeps narrow signals visible however wide the range.
+class SpectrumStitcher {
+public:
+  void configure(double startHz, double stopHz, double rate, int fftSize,
+                 double usableFraction = 0.75, int maxBins = 16384);
+  bool configured() const { return hopCount > 0; }
+
+  int hops() const { return hopCount; }
+  // LO frequency of hop `hop`, counted from the low end
+  double hopCenter(int hop) const {
+    return rangeStart + (double(hop) + 0.5) * hopWidth;
+  }
+  // what the row spans: startHz up to the end of the last hop
+  double startHz() const { return rangeStart; }
+  double stopHz() const { return rangeStart + double(hopCount) * hopWidth; }
+  int fftSize() const { return N; }
+
+  // Adds the FFT-shifted amplitudes (fftSize() bins, DC in the middle)
+  // of hop `hop` to the row.
+  void add(int hop, const float *amps);
+  const std::vector<float> &row() const { return bins; }
+  void clear();
+
+private:
+  static constexpr int kDcBins = 2; // either side of DC
+
+  double rangeStart{0.0};
+  double binHz{1.0};    // FFT bin width
+  double rowBinHz{1.0}; // row bin width, a whole number of FFT bins or more
+  double hopWidth{0.0};
+  int N{0};
+  int keep{0}; // bins kept either side of DC
+  int hopCount{0};
+  std::vector<float> bins;
+};
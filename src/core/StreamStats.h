@@ -0,0 +1,57 @@
+#pragma once
+#include <QMetaType>
+#include <QString>
+
+// A stretch of the RX stream whose samples never arrived. The reader
+// writes zeros in their place, so stream indices (and the files built on
+// them) keep counting device samples; samples == 0 marks a loss of
+// unknown length (an overflow on a device without timestamps).
+struct StreamGap {
+  enum Cause {
+    Overflow,  // the driver reported an overflow
+    TimeJump,  // device timestamps skipped ahead
+    Dropped,   // the reader's ring was full
+    Restart,   // the device was reopened after a fault
+    Unwritten, // in a file only: the disk writer had no buffer free
+  };
+  quint64 index{0}; // first missing sample (stream index, or file offset)
+  quint64 samples{0};
+  Cause cause{Overflow};
+
+  static QString causeName(Cause c) {
+    switch (c) {
+    case Overflow:
+      return "overflow";
+    case TimeJump:
+      return "time jump";
+    case Dropped:
+      return "dropped";
+    case Restart:
+      return "device restart";
+    case Unwritten:
+      return "not written (disk busy)";
+    }
+    return {};
+  }
+};
+
+// Running totals of the RX stream's health since the stream started,
+// for one device.
+struct StreamStats {
+  int device{0};  // pipeline index, 0 = the first SDR
+  QString serial; // empty if the driver reports none
+  // samples the DSP thread took per second over the last report, against
+  // the nominal rate: below it, the host is not keeping up
+  double samplesPerSecond{0.0};
+  double sampleRate{0.0};
+  double ringFill{0.0}; // reader -> DSP ring, 0..1
+  quint64 overflows{0};
+  quint64 timeouts{0};
+  quint64 timeJumps{0};
+  quint64 droppedSamples{0}; // refused by the reader's ring
+  quint64 zeroFilled{0};     // written as zeros in place of lost samples
+  quint64 gaps{0};
+  quint64 restarts{0}; // device reopened by the watchdog
+  quint64 settleDiscarded{0}; // taken while a retune was settling
+};
+Q_DECLARE_METATYPE(StreamStats)
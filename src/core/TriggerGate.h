@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+
+// Dwell / post-roll state machine behind a trigger. It is fed one detector
+// reading at a time, each with the stream index of its first sample and the
+// number of samples it covers, and reports the edges: Rise once the level
+// has stayed at or above threshold for needAbove samples, Fall once it has
+// then stayed below for needBelow. An edge sits on the first sample of the
+// run that satisfied it, so its position does not depend on how readings
+// line up with blocks.
+class TriggerGate {
+public:
+  enum Edge { None, Rise, Fall };
+
+  void reset() { *this = TriggerGate(); }
+
+  Edge step(bool above, uint64_t first, uint64_t samples, uint64_t needAbove,
+            uint64_t needBelow) {
+    if (above) {
+      if (aboveRun == 0)
+        aboveFirst = first;
+      aboveRun += samples;
+      belowRun = 0;
+    } else {
+      if (belowRun == 0)
+        belowFirst = first;
+      belowRun += samples;
+      aboveRun = 0;
+    }
+    if (!isOpen) {
+      if (above && aboveRun >= needAbove) {
+        isOpen = true;
+        rise = aboveFirst;
+        return Rise;
+      }
+    } else if (!above && belowRun >= needBelow) {
+      isOpen = false;
+      fall = belowFirst;
+      return Fall;
+    }
+    return None;
+  }
+
+  bool open() const { return isOpen; }
+  uint64_t riseIndex() const { return rise; }
+  uint64_t fallIndex() const { return fall; }
+
+private:
+  bool isOpen{false};
+  uint64_t aboveRun{0};
+  uint64_t belowRun{0};
+  uint64_t aboveFirst{0};
+  uint64_t belowFirst{0};
+  uint64_t rise{0};
+  uint64_t fall{0};
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free "latest value" mailbox between one producer and one consumer.
+// The producer fills writeBuffer() and publish()es it; the consumer fetch()es
+// and reads readBuffer(). Three slots rotate so neither side ever waits or
+// copies: a frame the consumer has not picked up yet is simply replaced by
+// the next one. Slots are reused, so once they have grown to the frame size
+// the handoff does no allocation.
+template <typename T> class TripleBuffer {
+public:
+  // Producer side
+  T &writeBuffer() { return bufs[back]; }
+  void publish() {
+    const uint8_t old =
+        middle.exchange(uint8_t(back | kFresh), std::memory_order_acq_rel);
+    back = old & kIndexMask;
+  }
+
+  // Consumer side. Returns false if nothing new was published since the last
+  // fetch(); readBuffer() then still holds the previous frame.
+  bool fetch() {
+    if (!(middle.load(std::memory_order_acquire) & kFresh))
+      return false;
+    const uint8_t old = middle.exchange(front, std::memory_order_acq_rel);
+    front = old & kIndexMask;
+    return true;
+  }
+  const T &readBuffer() const { return bufs[front]; }
+
+private:
+  static constexpr uint8_t kIndexMask = 0x3;
+  static constexpr uint8_t kFresh = 0x4;
+
+  T bufs[3];
+  uint8_t back{0};                            // producer-owned
+  alignas(64) std::atomic<uint8_t> middle{1}; // shared: index | kFresh
+  alignas(64) uint8_t front{2};               // consumer-owned
+};
@@ -1,19 +1,32 @@
 
+#include "core/FftPlanCache.h"
 #include "ui/MainWindow.h"
 #include "ui/SplashScreen.h"
 #include <QApplication>
 
 int main(int argc, char *argv[]) {
   QApplication app(argc, argv);
-  SplashScreen splash;
+  // reuse FFTW plans measured in earlier runs
+  FftPlanCache::instance().loadWisdom();
+  SDRManager devices;
+  SplashScreen splash(&devices);
   MainWindow mainWin;
 
   QObject::connect(&splash, &SplashScreen::bothDevicesReady, [&]() {
     splash.hide();
+    // the receiver opens the device it was told about from the start
+    mainWin.setDevices(devices.devices());
     mainWin.show();
     mainWin.startWaterfall(); // new helper below
   });
 
+  // later hotplug changes
+  QObject::connect(&devices, &SDRManager::devicesChanged, &mainWin,
+                   &MainWindow::setDevices);
+
   splash.show();
-  return app.exec();
+  devices.start();
+  const int rc = app.exec();
+  FftPlanCache::instance().saveWisdom();
+  return rc;
 }
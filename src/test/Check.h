@@ -0,0 +1,53 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+// Bare-bones checks for the unit test executables: a failing check prints
+// where it failed (and the current context, e.g. the kernel variant), and
+// main() returns test::failures() so ctest sees the result.
+namespace test {
+
+inline int &failures() {
+  static int n = 0;
+  return n;
+}
+
+inline std::string &context() {
+  static std::string c;
+  return c;
+}
+
+inline bool report(bool ok, const char *file, int line, const char *what) {
+  if (!ok) {
+    ++failures();
+    std::fprintf(stderr, "%s:%d: [%s] check failed: %s\n", file, line,
+                 context().c_str(), what);
+  }
+  return ok;
+}
+
+inline bool near(double a, double b, double tol, const char *file, int line,
+                 const char *what) {
+  const bool ok = std::fabs(a - b) <= tol;
+  if (!ok) {
+    ++failures();
+    std::fprintf(stderr, "%s:%d: [%s] %s: %.9g vs %.9g (tol %.3g)\n", file,
+                 line, context().c_str(), what, a, b, tol);
+  }
+  return ok;
+}
+
+inline int finish(const char *name) {
+  if (failures() == 0)
+    std::printf("%s: all checks passed\n", name);
+  else
+    std::fprintf(stderr, "%s: %d check(s) failed\n", name, failures());
+  return failures() == 0 ? 0 : 1;
+}
+
+} // namespace test
+
+#define CHECK(cond) ::test::report((cond), __FILE__, __LINE__, #cond)
+#define CHECK_NEAR(a, b, tol)                                                 \
+  ::test::near((a), (b), (tol), __FILE__, __LINE__, #a " ~ " #b)
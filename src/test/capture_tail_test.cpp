@@ -0,0 +1,104 @@
+// Capture tail: a triggered capture records on past release + post-roll
+// by the chain's delay plus one decimated sample before the job flushes
+// the filters with zeros. The trimmed file must then end exactly as the
+// same chain fed real samples throughout, never in a filter decay.
+#include "Check.h"
+#include "Decimator.h"
+#include "Resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using cf = std::complex<float>;
+
+struct Case {
+  double rate, spanHalf, outRate; // outRate 0: rate / D
+};
+
+// The worker's capture chain for a case.
+void configure(const Case &c, Decimator &d, Resampler &r) {
+  int D = Decimator::factorFor(c.rate, c.spanHalf);
+  if (c.outRate > 0.0)
+    D = std::clamp(int(std::floor(c.rate / c.outRate)), 1, D);
+  d.configure(c.rate, c.spanHalf, D);
+  r.configure(d.outputRate(), c.outRate > 0.0 ? c.outRate : d.outputRate(),
+              c.spanHalf);
+}
+
+// Feeds x[0, n), then flushes the way CaptureJob does.
+std::vector<cf> record(const Case &c, const std::vector<cf> &x, size_t n) {
+  Decimator d;
+  Resampler r;
+  configure(c, d, r);
+  std::vector<cf> stage, out, tail;
+  d.process(x.data(), n, stage);
+  r.process(stage.data(), stage.size(), out);
+  d.flush(tail);
+  r.process(tail.data(), tail.size(), out);
+  r.flush(out);
+  return out;
+}
+
+// Largest difference over the last `count` outputs before `stop`.
+double tailError(const std::vector<cf> &got, const std::vector<cf> &ref,
+                 size_t stop, size_t count) {
+  double err = 0.0;
+  for (size_t k = stop - count; k < stop; ++k)
+    err = std::max(err, double(std::abs(got[k] - ref[k])));
+  return err;
+}
+
+} // namespace
+
+int main() {
+  const Case cases[] = {
+      {2.4e6, 100.0e3, 0.0},
+      {2.4e6, 100.0e3, 250.0e3},
+      {2.6e6, 12.5e3, 48.0e3},
+      {2.048e6, 400.0e3, 0.0},
+      {2.4e6, 1.0e3, 0.0},
+  };
+  std::mt19937 rng(16);
+  std::normal_distribution<float> noise;
+  for (const Case &c : cases) {
+    test::context() = std::to_string(c.rate) + " span " +
+                      std::to_string(c.spanHalf) + " out " +
+                      std::to_string(c.outRate);
+    Decimator d;
+    Resampler r;
+    configure(c, d, r);
+    const double delay = d.delay() + double(d.factor()) * r.delay();
+    const double step = c.rate / r.outputRate();
+
+    // release + post-roll lands at `to`; the reference keeps going well
+    // past it, so none of its outputs up to there saw the flush
+    const size_t to = 200000;
+    std::vector<cf> x(to + 4 * size_t(std::ceil(delay)) + 100000);
+    for (cf &v : x)
+      v = cf(noise(rng), noise(rng));
+    const std::vector<cf> ref = record(c, x, x.size());
+
+    // outputs centred before `to` are kept (finishTriggeredCapture)
+    const size_t stop = size_t(std::ceil((double(to) - delay) / step - 1e-9));
+    const size_t check = std::min<size_t>(64, stop);
+    CHECK(stop <= ref.size());
+
+    const size_t end =
+        to + size_t(std::ceil(delay)) + size_t(std::max(1, d.factor()));
+    const std::vector<cf> got = record(c, x, end);
+    CHECK(got.size() >= stop);
+    CHECK(tailError(got, ref, stop, check) == 0.0);
+
+    // stopping at `to` itself, as before, leaves the tail in the decay
+    const std::vector<cf> early = record(c, x, to);
+    CHECK(early.size() >= stop);
+    CHECK(tailError(early, ref, stop, check) > 1e-3);
+  }
+  return test::finish("capture_tail_test");
+}
@@ -0,0 +1,99 @@
+// Channelizer: a tone lands in the channel of its frequency at unit gain
+// and well below that in every other one, in phase with the documented
+// delay(); output count and block-split invariance.
+#include "Channelizer.h"
+#include "Check.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using cf = std::complex<float>;
+
+std::vector<cf> tone(double f, size_t n) {
+  std::vector<cf> x(n);
+  for (size_t i = 0; i < n; ++i)
+    x[i] = std::polar(1.0f, float(2.0 * M_PI * f * double(i)));
+  return x;
+}
+
+// mean power of out[skip..], in dB
+double powerDb(const std::vector<cf> &out, size_t skip) {
+  double p = 0.0;
+  for (size_t i = skip; i < out.size(); ++i)
+    p += std::norm(out[i]);
+  return 10.0 * std::log10(p / double(out.size() - skip) + 1e-30);
+}
+
+} // namespace
+
+int main() {
+  for (int M : {2, 4, 5, 8, 16}) {
+    Channelizer c;
+    c.configure(M);
+    const int P = 16; // the default taps per branch
+    const size_t n = size_t(M) * 1024;
+    // the first full window ends on input M * P, then one output per M
+    const size_t expectOut = (n - 1 - size_t(M * P)) / size_t(M) + 1;
+    // skip the outputs whose window reached before the first input
+    const size_t skip = size_t(P);
+    for (int k = 0; k < M; ++k) {
+      test::context() = "M=" + std::to_string(M) + " k=" + std::to_string(k);
+      c.reset();
+      // a little off the channel centre, well inside its passband
+      const double offset = 0.1 / double(M);
+      const double f = c.channelOffset(k) + offset;
+      std::vector<std::vector<cf>> out;
+      c.process(tone(f, n).data(), n, out);
+      CHECK(int(out.size()) == M);
+      CHECK(out[size_t(k)].size() == expectOut);
+
+      CHECK_NEAR(powerDb(out[size_t(k)], skip), 0.0, 0.1);
+      double leak = -300.0;
+      for (int j = 0; j < M; ++j) {
+        if (j != k)
+          leak = std::max(leak, powerDb(out[size_t(j)], skip));
+      }
+      CHECK(leak < -60.0);
+
+      // output i is the tone's offset from the channel centre, sampled at
+      // input delay() + i * M
+      double phaseErr = 0.0;
+      for (size_t i = skip; i < out[size_t(k)].size(); ++i) {
+        const double t = c.delay() + double(i) * double(M);
+        const std::complex<double> ideal =
+            std::polar(1.0, 2.0 * M_PI * offset * t);
+        phaseErr = std::max(
+            phaseErr,
+            std::abs(std::arg(std::complex<double>(out[size_t(k)][i]) /
+                              ideal)));
+      }
+      CHECK(phaseErr < 1e-2);
+    }
+
+    // the same stream in random blocks gives the same outputs
+    test::context() = "M=" + std::to_string(M) + " blocks";
+    std::mt19937 rng(static_cast<uint32_t>(M));
+    std::normal_distribution<float> noise;
+    std::vector<cf> x(n);
+    for (cf &v : x)
+      v = cf(noise(rng), noise(rng));
+    std::vector<std::vector<cf>> whole, split;
+    c.reset();
+    c.process(x.data(), n, whole);
+    c.reset();
+    std::uniform_int_distribution<size_t> len(0, size_t(3 * M));
+    for (size_t off = 0; off < n;) {
+      const size_t count = std::min(len(rng), n - off);
+      c.process(x.data() + off, count, split);
+      off += count;
+    }
+    CHECK(whole == split);
+  }
+  return test::finish("channelizer_test");
+}
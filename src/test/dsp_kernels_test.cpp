@@ -0,0 +1,168 @@
+// Runs every DSP kernel variant this CPU supports against the scalar
+// reference, over lengths that do and do not fill whole vectors and with
+// buffers off any vector alignment.
+#include "Check.h"
+#include "DspKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int kLengths[] = {0,  1,  2,  3,  4,  5,  7,   8,   9,   15,  16,
+                        17, 31, 32, 33, 63, 64, 65, 100, 127, 1023, 4096};
+
+std::mt19937 rng(1234);
+
+std::vector<float> uniform(size_t n, float lo, float hi) {
+  std::uniform_real_distribution<float> d(lo, hi);
+  std::vector<float> v(n);
+  for (float &x : v)
+    x = d(rng);
+  return v;
+}
+
+// relative tolerance with an absolute floor, for results whose rounding
+// depends on operation order (FMA, lane-wise sums)
+double tol(double ref, double rel, double abs) {
+  return std::max(abs, rel * std::fabs(ref));
+}
+
+struct Inputs {
+  int n;
+  // one extra element in front so the data starts off vector alignment
+  std::vector<float> z, w, x, state, amp;
+  std::vector<std::complex<float>> c;
+  std::vector<dsp::Cs8> iq;
+  std::vector<float> hh;
+
+  explicit Inputs(int n) : n(n) {
+    z = uniform(2 * size_t(n) + 1, -4.0f, 4.0f);
+    w = uniform(size_t(n) + 1, 0.0f, 1.0f);
+    x = uniform(size_t(n) + 1, 0.0f, 2.0f);
+    state = uniform(size_t(n) + 1, 0.0f, 2.0f);
+    // amplitudes across the whole range amplitudeToDb sees, below the
+    // floor included
+    amp = uniform(size_t(n) + 1, 0.0f, 1.0f);
+    for (size_t i = 1; i < amp.size(); i += 3)
+      amp[i] = std::pow(10.0f, -8.0f * amp[i]);
+    const std::vector<float> re = uniform(size_t(n) + 1, -1.0f, 1.0f);
+    const std::vector<float> im = uniform(size_t(n) + 1, -1.0f, 1.0f);
+    for (size_t i = 0; i < re.size(); ++i)
+      c.emplace_back(re[i], im[i]);
+    std::uniform_int_distribution<int> s8(-128, 127);
+    iq.resize(size_t(n) + 1);
+    for (dsp::Cs8 &s : iq)
+      s = {int8_t(s8(rng)), int8_t(s8(rng))};
+    const std::vector<float> h = uniform(size_t(n) + 1, -0.5f, 0.5f);
+    for (float t : h) {
+      hh.push_back(t);
+      hh.push_back(t);
+    }
+  }
+};
+
+struct Outputs {
+  std::vector<float> window, magnitude, power, smoothOut, smoothState, db,
+      maxHold;
+  float maxValue{0.0f};
+  std::complex<float> firDot;
+  std::vector<std::complex<float>> cs8;
+};
+
+Outputs run(const Inputs &in) {
+  const int n = in.n;
+  Outputs out;
+  out.window.assign(2 * size_t(n) + 1, 0.0f);
+  dsp::windowToComplex(in.c.data() + 1, in.w.data() + 1,
+                       out.window.data() + 1, n);
+  out.magnitude.assign(size_t(n) + 1, 0.0f);
+  dsp::magnitude(in.z.data() + 1, 0.25f, out.magnitude.data() + 1, n);
+  out.power.assign(size_t(n) + 1, 0.0f);
+  dsp::power(in.z.data() + 1, 0.25f, out.power.data() + 1, n);
+  out.smoothState = in.state;
+  out.smoothOut.assign(size_t(n) + 1, 0.0f);
+  dsp::smooth(in.x.data() + 1, out.smoothState.data() + 1, 0.3f, 1.5f,
+              out.smoothOut.data() + 1, n);
+  out.db.assign(size_t(n) + 1, 0.0f);
+  dsp::amplitudeToDb(in.amp.data() + 1, 1e-6f, out.db.data() + 1, n);
+  out.maxHold = in.state;
+  dsp::maxHold(out.maxHold.data() + 1, in.x.data() + 1, n);
+  out.maxValue = dsp::maxValue(in.x.data() + 1, n);
+  out.firDot = dsp::firDot(in.c.data() + 1, in.hh.data() + 2, n);
+  out.cs8.assign(size_t(n) + 1, {0.0f, 0.0f});
+  dsp::cs8ToComplex(in.iq.data() + 1, 1.0f / 128.0f, out.cs8.data() + 1, n);
+  return out;
+}
+
+void compare(const Inputs &in, const Outputs &ref, const Outputs &got) {
+  const int n = in.n;
+  // nothing outside [1, n] may be touched
+  CHECK(got.window[0] == 0.0f && got.magnitude[0] == 0.0f &&
+        got.power[0] == 0.0f && got.smoothOut[0] == 0.0f &&
+        got.db[0] == 0.0f);
+  CHECK(got.smoothState[0] == in.state[0] && got.maxHold[0] == in.state[0]);
+  for (size_t i = 0; i < got.window.size(); ++i)
+    CHECK_NEAR(got.window[i], ref.window[i], tol(ref.window[i], 1e-6, 0.0));
+  for (int i = 1; i <= n; ++i) {
+    CHECK_NEAR(got.magnitude[i], ref.magnitude[i],
+               tol(ref.magnitude[i], 2e-6, 1e-7));
+    CHECK_NEAR(got.power[i], ref.power[i], tol(ref.power[i], 2e-6, 1e-7));
+    CHECK_NEAR(got.smoothState[i], ref.smoothState[i],
+               tol(ref.smoothState[i], 2e-6, 1e-7));
+    CHECK_NEAR(got.smoothOut[i], ref.smoothOut[i],
+               tol(ref.smoothOut[i], 2e-6, 1e-7));
+    CHECK(got.smoothOut[i] <= 1.5f);
+    // the vector variants evaluate log10 by a short series
+    CHECK_NEAR(got.db[i], ref.db[i], 2e-4);
+    CHECK(got.maxHold[i] == ref.maxHold[i]);
+    CHECK(got.cs8[i] == ref.cs8[i]);
+  }
+  if (n <= 0)
+    CHECK(got.maxValue == -std::numeric_limits<float>::infinity());
+  else
+    CHECK(got.maxValue == ref.maxValue);
+  // lane-wise partial sums: allow for the reordering against the sum of
+  // magnitudes
+  double mass = 0.0;
+  for (int i = 0; i < n; ++i)
+    mass += std::abs(in.c[size_t(i) + 1]) * std::fabs(in.hh[2 * size_t(i) + 2]);
+  CHECK_NEAR(got.firDot.real(), ref.firDot.real(), 1e-6 * mass + 1e-7);
+  CHECK_NEAR(got.firDot.imag(), ref.firDot.imag(), 1e-6 * mass + 1e-7);
+}
+
+} // namespace
+
+int main() {
+  const std::vector<const char *> isas = dsp::supportedIsas();
+  CHECK(!isas.empty() && std::string(isas.front()) == "scalar");
+  for (const char *isa : isas)
+    std::printf("variant: %s\n", isa);
+
+  for (int n : kLengths) {
+    const Inputs in(n);
+    test::context() = "scalar n=" + std::to_string(n);
+    CHECK(dsp::selectIsa("scalar"));
+    const Outputs ref = run(in);
+    // the scalar reference itself, against double precision
+    for (int i = 1; i <= n; ++i) {
+      const double re = in.z[2 * size_t(i) - 1], im = in.z[2 * size_t(i)];
+      CHECK_NEAR(ref.power[i], 0.25 * (re * re + im * im),
+                 tol(ref.power[i], 1e-6, 1e-7));
+      CHECK_NEAR(ref.db[i],
+                 20.0 * std::log10(std::max(double(in.amp[i]), 1e-6)), 1e-4);
+    }
+    for (const char *isa : isas) {
+      test::context() = std::string(isa) + " n=" + std::to_string(n);
+      CHECK(dsp::selectIsa(isa));
+      CHECK(std::string(dsp::isaName()) == isa);
+      compare(in, ref, run(in));
+    }
+  }
+  CHECK(!dsp::selectIsa("no-such-isa"));
+  return test::finish("dsp_kernels_test");
+}
@@ -0,0 +1,87 @@
+// FrameAssembler: frames are contiguous stream slices at the reported
+// index for any block sizes, with or without overlap, and no sample is
+// lost when the frame size changes.
+#include "Check.h"
+#include "FrameAssembler.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Feeds a counting stream in random blocks and checks every frame; the
+// frame size changes now and then when `resize` is set.
+void run(size_t frame, size_t hop, bool resize) {
+  FrameAssembler<uint32_t> fa;
+  fa.setFrameSize(frame);
+  std::mt19937 rng(uint32_t(frame * 31 + hop));
+  std::uniform_int_distribution<size_t> len(0, 3 * frame);
+  std::vector<uint32_t> block;
+  uint32_t next = 0;
+  uint64_t expectIndex = 0;
+  uint64_t lastEnd = 0; // end of the samples delivered so far
+  int frames = 0;
+  bool contiguous = true, indexed = true, fresh = true;
+  while (frames < 2000) {
+    block.resize(len(rng));
+    for (uint32_t &v : block)
+      v = next++;
+    for (size_t off = 0; off < block.size();) {
+      off += fa.feed(block.data() + off, block.size() - off);
+      if (!fa.frameReady())
+        continue;
+      const uint32_t *f = fa.frame();
+      const size_t n = fa.frameSize();
+      for (size_t k = 0; k < n; ++k)
+        contiguous = contiguous && f[k] == uint32_t(fa.frameIndex() + k);
+      indexed = indexed && fa.frameIndex() == expectIndex;
+      // the fresh part starts after everything delivered so far (all of
+      // a frame that shrank inside the previous one is old)
+      const uint64_t old = std::min<uint64_t>(lastEnd - fa.frameIndex(), n);
+      fresh = fresh && fa.freshOffset() == old;
+      lastEnd = std::max<uint64_t>(lastEnd, fa.frameIndex() + n);
+      const size_t step = hop ? std::min(hop, n) : n;
+      fa.consumeFrame(step);
+      expectIndex += step;
+      ++frames;
+      if (resize && frames % 97 == 0)
+        fa.setFrameSize(frame / 2 + size_t(frames % 5) * frame / 4);
+    }
+  }
+  CHECK(contiguous);
+  CHECK(indexed);
+  CHECK(fresh);
+  CHECK(fa.samplesIn() == next);
+  CHECK(fa.samplesIn() == expectIndex + fa.pending());
+}
+
+} // namespace
+
+int main() {
+  for (size_t frame : {1, 7, 64, 1024}) {
+    for (size_t hop : {size_t(0), frame / 2, frame / 4 + 1}) {
+      for (bool resize : {false, true}) {
+        test::context() = "frame=" + std::to_string(frame) +
+                          " hop=" + std::to_string(hop) +
+                          (resize ? " resizing" : "");
+        run(frame, hop, resize);
+      }
+    }
+  }
+  // feed() takes nothing once a frame is ready
+  {
+    test::context() = "full";
+    FrameAssembler<int> fa;
+    fa.setFrameSize(4);
+    const int x[6] = {0, 1, 2, 3, 4, 5};
+    CHECK(fa.feed(x, 6) == 4 && fa.frameReady());
+    CHECK(fa.feed(x + 4, 2) == 0);
+    fa.consumeFrame(2);
+    CHECK(!fa.frameReady() && fa.pending() == 2 && fa.freshOffset() == 2);
+    CHECK(fa.feed(x + 4, 2) == 2 && fa.frameReady());
+    CHECK(fa.frame()[0] == 2 && fa.frameIndex() == 2);
+  }
+  return test::finish("frame_assembler_test");
+}
@@ -0,0 +1,49 @@
+// HistoryRing: latest(n) returns the newest samples in stream order for
+// any mix of block sizes, blocks larger than the ring included.
+#include "Check.h"
+#include "HistoryRing.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+int main() {
+  HistoryRing<uint32_t> ring;
+  ring.reset(1000);
+  std::vector<uint32_t> stream; // everything written, for reference
+  std::mt19937 rng(9);
+  std::uniform_int_distribution<size_t> len(0, 400);
+  std::uniform_int_distribution<int> big(0, 19);
+  bool ordered = true, sized = true, spans = true;
+  for (int i = 0; i < 3000; ++i) {
+    // now and then a block larger than the whole ring
+    const size_t n = big(rng) == 0 ? 2500 : len(rng);
+    std::vector<uint32_t> block(n);
+    for (uint32_t &v : block)
+      v = uint32_t(stream.size() + (&v - block.data()));
+    ring.write(block.data(), n);
+    stream.insert(stream.end(), block.begin(), block.end());
+    sized = sized && ring.size() == std::min(stream.size(), ring.capacity());
+
+    const size_t want = len(rng) * 3;
+    const HistoryRing<uint32_t>::Spans s = ring.latest(want);
+    const size_t got = std::min(want, ring.size());
+    spans = spans && s.size() == got && (s.secondLen == 0 || s.second);
+    const size_t from = stream.size() - got;
+    for (size_t k = 0; k < s.firstLen; ++k)
+      ordered = ordered && s.first[k] == stream[from + k];
+    for (size_t k = 0; k < s.secondLen; ++k)
+      ordered = ordered && s.second[k] == stream[from + s.firstLen + k];
+  }
+  CHECK(ordered);
+  CHECK(sized);
+  CHECK(spans);
+
+  ring.clear();
+  CHECK(ring.size() == 0 && ring.latest(10).size() == 0);
+  HistoryRing<uint32_t> empty;
+  const uint32_t x = 1;
+  empty.write(&x, 1);
+  CHECK(empty.size() == 0 && empty.latest(1).size() == 0);
+  return test::finish("history_ring_test");
+}
@@ -0,0 +1,164 @@
+// Resampler: output count against the polyphase window walk, alignment
+// against the documented delay(), passband gain out to the cutoff and
+// rejection of what would fold into it, for exact and approximated ratios.
+#include "Check.h"
+#include "Resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using cf = std::complex<float>;
+
+struct Case {
+  double in, out, cutoff;
+};
+
+std::vector<cf> tone(double f, double rate, size_t n) {
+  std::vector<cf> x(n);
+  for (size_t i = 0; i < n; ++i) {
+    const double ph = 2.0 * M_PI * f / rate * double(i);
+    x[i] = cf(float(std::cos(ph)), float(std::sin(ph)));
+  }
+  return x;
+}
+
+// input position output j is centred on
+double centre(const Resampler &r, size_t j) {
+  return r.delay() + double(j) * double(r.down()) / double(r.up());
+}
+
+// Complex gain at f against the ideal tone at each output's documented
+// centre; real and positive when delay() is right.
+std::complex<double> gainAt(Resampler &r, double rate, double f) {
+  r.reset();
+  const size_t n = 4096;
+  std::vector<cf> out;
+  r.process(tone(f, rate, n).data(), n, out);
+  std::complex<double> acc = 0.0;
+  size_t used = 0;
+  for (size_t j = 0; j < out.size(); ++j) {
+    const double c = centre(r, j);
+    if (c < 2.0 * r.delay())
+      continue;
+    const double ph = 2.0 * M_PI * f / rate * c;
+    acc += std::complex<double>(out[j]) *
+           std::complex<double>(std::cos(ph), -std::sin(ph));
+    ++used;
+  }
+  return used > 0 ? acc / double(used) : 0.0;
+}
+
+// mean output power for a unit tone at f, in dB
+double powerAt(Resampler &r, double rate, double f) {
+  r.reset();
+  const size_t n = 4096;
+  std::vector<cf> out;
+  r.process(tone(f, rate, n).data(), n, out);
+  double acc = 0.0;
+  size_t used = 0;
+  for (size_t j = 0; j < out.size(); ++j) {
+    if (centre(r, j) < 2.0 * r.delay())
+      continue;
+    acc += double(std::norm(out[j]));
+    ++used;
+  }
+  return 10.0 * std::log10(std::max(acc / double(std::max<size_t>(used, 1)),
+                                    1e-15));
+}
+
+void checkCounts(const Case &c) {
+  Resampler r;
+  r.configure(c.in, c.out, c.cutoff);
+  CHECK(r.up() >= 1 && r.down() >= 1 && r.up() <= Resampler::kMaxPhases);
+  CHECK_NEAR(r.outputRate(), c.in * r.up() / r.down(), 1e-6 * c.in);
+  const size_t n = 20000;
+  std::vector<cf> x(n);
+  std::mt19937 rng(11);
+  std::normal_distribution<float> g;
+  for (cf &v : x)
+    v = cf(g(rng), g(rng));
+
+  std::vector<cf> whole;
+  r.process(x.data(), n, whole);
+  // one output per window of K inputs starting at floor(j * M / L)
+  const double L = r.up(), M = r.down(), K = r.tapsPerPhase();
+  size_t expect = 0;
+  while (std::floor(double(expect) * M / L) + K <= double(n))
+    ++expect;
+  CHECK(whole.size() == expect);
+
+  r.reset();
+  std::vector<cf> pieces;
+  std::uniform_int_distribution<size_t> len(0, 700);
+  for (size_t i = 0; i < n;) {
+    const size_t m = std::min(n - i, len(rng));
+    r.process(x.data() + i, m, pieces);
+    i += m;
+  }
+  bool same = pieces.size() == whole.size();
+  for (size_t i = 0; same && i < whole.size(); ++i)
+    same = pieces[i] == whole[i];
+  CHECK(same);
+
+  // flush brings out every output centred on an input that was fed
+  std::vector<cf> tail;
+  r.flush(tail);
+  CHECK(centre(r, whole.size() + tail.size() - 1) >= double(n) - 1.0 - M / L);
+}
+
+void checkResponse(const Case &c) {
+  Resampler r;
+  r.configure(c.in, c.out, c.cutoff);
+  const double pass = std::min(c.cutoff, 0.45 * std::min(c.in, c.out));
+  for (double frac : {0.0, 0.25, -0.5, 0.8, -0.9, 1.0, -1.0}) {
+    test::context() = std::to_string(c.in) + "->" + std::to_string(c.out) +
+                      " f=" + std::to_string(frac) + "*cutoff";
+    const std::complex<double> g = gainAt(r, c.in, frac * pass);
+    CHECK_NEAR(20.0 * std::log10(std::abs(g)), 0.0, 0.1);
+    CHECK_NEAR(std::arg(g), 0.0, 0.01);
+  }
+  // tones that would land in the passband on the lower of the two rates
+  const double low = std::min(c.in, c.out);
+  const double first = low - pass, last = 0.5 * c.in;
+  for (int i = 0; i <= 8 && first < last; ++i) {
+    const double f = first + (last - first) * i / 8.0;
+    for (double sign : {1.0, -1.0}) {
+      test::context() = std::to_string(c.in) + "->" + std::to_string(c.out) +
+                        " stop f=" + std::to_string(sign * f);
+      CHECK(powerAt(r, c.in, sign * f) < -60.0);
+    }
+  }
+}
+
+} // namespace
+
+int main() {
+  const Case cases[] = {
+      {260000.0, 250000.0, 100000.0}, // decimator output to a round rate
+      {866666.0, 500000.0, 200000.0}, // 2.6 Msps / 3 down to 500 kHz
+      {200000.0, 192000.0, 80000.0},
+      {250000.0, 260000.0, 100000.0}, // upsampling
+      {1e6 / 3.0, 100000.0, 40000.0}, // non-integral: approximated L/M
+  };
+  for (const Case &c : cases) {
+    test::context() = std::to_string(c.in) + "->" + std::to_string(c.out);
+    checkCounts(c);
+    checkResponse(c);
+  }
+
+  // unconfigured and 1:1 pass samples straight through
+  Resampler same;
+  same.configure(250000.0, 250000.0, 100000.0);
+  const std::vector<cf> x = tone(1000.0, 250000.0, 100);
+  std::vector<cf> out;
+  same.process(x.data(), x.size(), out);
+  test::context() = "passthrough";
+  CHECK(out == x);
+  CHECK(same.delay() == 0.0);
+  return test::finish("resampler_test");
+}
@@ -0,0 +1,93 @@
+// SampleRing: FIFO order across wraps, drop accounting when full, and
+// one producer thread against one consumer thread.
+#include "Check.h"
+#include "SampleRing.h"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+
+int main() {
+  {
+    test::context() = "capacity";
+    SampleRing<int> ring(1000);
+    CHECK(ring.capacity() == 1024);
+    SampleRing<int> none;
+    CHECK(none.capacity() == 0);
+    const int x = 1;
+    CHECK(none.write(&x, 1) == 0 && none.droppedSamples() == 1);
+  }
+  // random write / read sizes against a plain queue
+  {
+    test::context() = "model";
+    SampleRing<uint32_t> ring(64);
+    std::deque<uint32_t> model;
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<size_t> len(0, 50);
+    uint32_t next = 0;
+    uint64_t dropped = 0;
+    size_t high = 0;
+    std::vector<uint32_t> block(64), got(64);
+    for (int i = 0; i < 5000; ++i) {
+      const size_t w = len(rng);
+      for (size_t k = 0; k < w; ++k)
+        block[k] = next++;
+      const size_t stored = ring.write(block.data(), w);
+      CHECK(stored == std::min(w, ring.capacity() - model.size()));
+      model.insert(model.end(), block.begin(), block.begin() + long(stored));
+      dropped += w - stored;
+      high = std::max(high, model.size());
+      CHECK(ring.fillLevel() == model.size());
+
+      const size_t r = ring.read(got.data(), len(rng));
+      bool same = r <= model.size();
+      for (size_t k = 0; same && k < r; ++k) {
+        same = got[k] == model.front();
+        model.pop_front();
+      }
+      CHECK(same);
+    }
+    CHECK(ring.droppedSamples() == dropped);
+    CHECK(ring.highWaterMark() == high);
+  }
+  // one producer, one consumer: every stored sample comes out once, in
+  // order
+  {
+    test::context() = "threads";
+    SampleRing<uint64_t> ring(4096);
+    const uint64_t total = 200000;
+    std::thread producer([&]() {
+      std::vector<uint64_t> block(777);
+      uint64_t next = 0;
+      while (next < total) {
+        const size_t n = size_t(std::min<uint64_t>(block.size(), total - next));
+        for (size_t k = 0; k < n; ++k)
+          block[k] = next + k;
+        // retry what did not fit so nothing is lost in this test
+        for (size_t done = 0; done < n;) {
+          const size_t w = ring.write(block.data() + done, n - done);
+          done += w;
+          if (w == 0)
+            std::this_thread::yield();
+        }
+        next += n;
+      }
+    });
+    std::vector<uint64_t> buf(1000);
+    uint64_t expect = 0;
+    bool inOrder = true;
+    while (expect < total) {
+      const size_t n = ring.read(buf.data(), buf.size());
+      for (size_t k = 0; k < n; ++k)
+        inOrder = inOrder && buf[k] == expect++;
+      if (n == 0)
+        std::this_thread::yield();
+    }
+    producer.join();
+    CHECK(inOrder);
+    CHECK(ring.available() == 0);
+  }
+  return test::finish("sample_ring_test");
+}
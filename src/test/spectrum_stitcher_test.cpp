@@ -0,0 +1,98 @@
+// SpectrumStitcher: hops tile the range edge to edge, the row stays within
+// maxBins with no gaps, and a tone lands in the row bin of its frequency.
+#include "Check.h"
+#include "SpectrumStitcher.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Case {
+  double start, stop, rate;
+  int fft;
+  double usable;
+  int maxBins;
+};
+
+void checkTiling(const Case &c) {
+  SpectrumStitcher s;
+  s.configure(c.start, c.stop, c.rate, c.fft, c.usable, c.maxBins);
+  CHECK(s.configured());
+  const double binHz = c.rate / c.fft;
+  const double covered = s.stopHz() - s.startHz();
+  const double width = covered / s.hops();
+  // the hops cover the range, by less than one hop too many
+  CHECK(s.startHz() == c.start);
+  CHECK(s.stopHz() >= c.stop - 1e-6);
+  CHECK(s.stopHz() - c.stop < width || s.hops() == 1);
+  // a whole, even number of FFT bins per hop, within the usable part
+  const double keptBins = width / binHz;
+  CHECK_NEAR(keptBins, std::round(keptBins), 1e-6);
+  CHECK(std::lround(keptBins) % 2 == 0);
+  CHECK(keptBins <= c.usable * c.fft + 1e-6);
+  // hop h keeps [start + h * width, start + (h + 1) * width)
+  for (int h = 0; h < s.hops(); ++h)
+    CHECK_NEAR(s.hopCenter(h) - 0.5 * width, c.start + h * width, 1e-3);
+
+  const int rowBins = int(s.row().size());
+  CHECK(rowBins >= 1 && rowBins <= c.maxBins);
+
+  // flat hops with a DC spike: every row bin is written, and the spike
+  // is bridged
+  const int N = s.fftSize();
+  std::vector<float> amps(size_t(N), 1.0f);
+  amps[size_t(N / 2)] = 100.0f;
+  amps[size_t(N / 2 + 1)] = 50.0f;
+  for (int h = 0; h < s.hops(); ++h)
+    s.add(h, amps.data());
+  const auto [lo, hi] = std::minmax_element(s.row().begin(), s.row().end());
+  CHECK(*lo == 1.0f && *hi == 1.0f);
+
+  // a tone in one bin of one hop lands in the row bin of its frequency;
+  // row bins are FFT bins until maxBins forces them wider
+  const double rowBinHz = std::max(binHz, covered / c.maxBins);
+  const int keep = int(std::lround(keptBins / 2));
+  for (int h : {0, s.hops() / 2, s.hops() - 1}) {
+    for (int j : {-keep, -keep / 2, 3, keep - 1}) {
+      s.clear();
+      std::vector<float> a(size_t(N), 0.5f);
+      a[size_t(N / 2 + j)] = 2.0f;
+      s.add(h, a.data());
+      const auto peak = std::max_element(s.row().begin(), s.row().end());
+      const double f = s.hopCenter(h) + j * binHz;
+      const int expect = std::min(
+          rowBins - 1, int(std::floor((f - c.start) / rowBinHz + 1e-6)));
+      test::context() = "hop " + std::to_string(h) + " bin " +
+                        std::to_string(j);
+      CHECK(*peak == 2.0f);
+      CHECK(int(peak - s.row().begin()) == expect);
+    }
+  }
+  s.clear();
+  CHECK(*std::max_element(s.row().begin(), s.row().end()) == 0.0f);
+  // hops outside the range are ignored
+  s.add(-1, amps.data());
+  s.add(s.hops(), amps.data());
+  CHECK(*std::max_element(s.row().begin(), s.row().end()) == 0.0f);
+}
+
+} // namespace
+
+int main() {
+  const Case cases[] = {
+      // a range narrower than one hop
+      {433.0e6, 434.0e6, 2.4e6, 4096, 0.75, 16384},
+      // several hops, the range not a whole number of them
+      {400.0e6, 470.3e6, 2.4e6, 2048, 0.75, 16384},
+      // the whole RTL-SDR range, folded into maxBins
+      {24.0e6, 1766.0e6, 2.6e6, 8192, 0.75, 16384},
+      {88.0e6, 108.0e6, 2.048e6, 512, 0.5, 1000},
+  };
+  for (const Case &c : cases) {
+    test::context() = std::to_string(c.start) + ".." + std::to_string(c.stop);
+    checkTiling(c);
+  }
+  return test::finish("spectrum_stitcher_test");
+}
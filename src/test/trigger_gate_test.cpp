@@ -0,0 +1,126 @@
+// TriggerGate: edges land on the first sample of the run that satisfied
+// the dwell / post-roll, however the readings are sized.
+#include "Check.h"
+#include "TriggerGate.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Run {
+  bool above;
+  uint64_t samples;
+};
+
+struct Edges {
+  std::vector<uint64_t> rises, falls;
+};
+
+// Feeds the runs in readings of `chunk` samples (the last reading of a run
+// may be shorter); chunk 0 picks random sizes.
+Edges feed(const std::vector<Run> &runs, uint64_t chunk, uint64_t needAbove,
+           uint64_t needBelow, std::mt19937 &rng) {
+  TriggerGate gate;
+  Edges e;
+  std::uniform_int_distribution<uint64_t> size(1, 37);
+  uint64_t index = 1000; // stream indices need not start at 0
+  for (const Run &r : runs) {
+    for (uint64_t done = 0; done < r.samples;) {
+      const uint64_t n =
+          std::min<uint64_t>(r.samples - done, chunk ? chunk : size(rng));
+      switch (gate.step(r.above, index, n, needAbove, needBelow)) {
+      case TriggerGate::Rise:
+        e.rises.push_back(gate.riseIndex());
+        break;
+      case TriggerGate::Fall:
+        e.falls.push_back(gate.fallIndex());
+        break;
+      case TriggerGate::None:
+        break;
+      }
+      index += n;
+      done += n;
+    }
+  }
+  return e;
+}
+
+} // namespace
+
+int main() {
+  std::mt19937 rng(3);
+
+  // the basic cycle: rise at the start of the above run, fall at the start
+  // of the below run that outlasted the post-roll
+  {
+    test::context() = "cycle";
+    const std::vector<Run> runs{{false, 30}, {true, 50}, {false, 40}};
+    const Edges e = feed(runs, 10, 30, 20, rng);
+    CHECK(e.rises.size() == 1 && e.rises[0] == 1030);
+    CHECK(e.falls.size() == 1 && e.falls[0] == 1080);
+  }
+  // an above run shorter than the dwell does not count towards the next
+  {
+    test::context() = "interrupted dwell";
+    const std::vector<Run> runs{
+        {true, 20}, {false, 10}, {true, 40}, {false, 30}};
+    const Edges e = feed(runs, 10, 30, 20, rng);
+    CHECK(e.rises.size() == 1 && e.rises[0] == 1030);
+    CHECK(e.falls.size() == 1 && e.falls[0] == 1070);
+  }
+  // a dip shorter than the post-roll keeps the gate open
+  {
+    test::context() = "short dip";
+    const std::vector<Run> runs{
+        {true, 40}, {false, 10}, {true, 10}, {false, 20}};
+    const Edges e = feed(runs, 5, 30, 20, rng);
+    CHECK(e.rises.size() == 1 && e.rises[0] == 1000);
+    CHECK(e.falls.size() == 1 && e.falls[0] == 1060);
+  }
+  // zero dwell: the first reading above rises, readings below never do
+  {
+    test::context() = "zero dwell";
+    const std::vector<Run> below{{false, 100}};
+    CHECK(feed(below, 10, 0, 20, rng).rises.empty());
+    const std::vector<Run> runs{{false, 15}, {true, 1}, {false, 30}};
+    const Edges e = feed(runs, 10, 0, 20, rng);
+    CHECK(e.rises.size() == 1 && e.rises[0] == 1015);
+    CHECK(e.falls.size() == 1 && e.falls[0] == 1016);
+  }
+  // Edges do not depend on how readings line up: random run patterns fed
+  // sample by sample and in random readings give the same indices.
+  for (int trial = 0; trial < 200; ++trial) {
+    test::context() = "random pattern " + std::to_string(trial);
+    std::vector<Run> runs;
+    std::uniform_int_distribution<uint64_t> len(1, 120);
+    bool above = trial % 2 == 0;
+    for (int i = 0; i < 30; ++i) {
+      runs.push_back({above, len(rng)});
+      above = !above;
+    }
+    const uint64_t needAbove = len(rng) / 2, needBelow = len(rng);
+    const Edges one = feed(runs, 1, needAbove, needBelow, rng);
+    const Edges any = feed(runs, 0, needAbove, needBelow, rng);
+    CHECK(one.rises == any.rises);
+    CHECK(one.falls == any.falls);
+    // rises and falls alternate, each fall after its rise
+    CHECK(one.falls.size() <= one.rises.size() &&
+          one.rises.size() <= one.falls.size() + 1);
+    for (size_t i = 0; i < one.falls.size(); ++i)
+      CHECK(one.rises[i] < one.falls[i]);
+  }
+  // reset() forgets a run in progress
+  {
+    test::context() = "reset";
+    TriggerGate gate;
+    CHECK(gate.step(true, 0, 20, 30, 10) == TriggerGate::None);
+    gate.reset();
+    CHECK(gate.step(true, 20, 20, 30, 10) == TriggerGate::None);
+    CHECK(gate.step(true, 40, 10, 30, 10) == TriggerGate::Rise);
+    CHECK(gate.open() && gate.riseIndex() == 20);
+  }
+  return test::finish("trigger_gate_test");
+}
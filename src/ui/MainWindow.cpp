@@ -3,15 +3,20 @@
 #include "../core/SDRTransmitter.h"
 #include <QApplication>
 #include <QCloseEvent>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
 #include <QFrame>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QRegularExpression>
 #include <QSizePolicy>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <algorithm>
+#include <limits>
 #include <qdatetime.h>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -185,6 +190,19 @@ MainWindow::MainWindow(QWidget *parent)
   txFreq->setRange(0.1, 6000);
   rxFreq->setValue(433.81);
   txFreq->setValue(434.20);
+  // wideband sweep range
+  sweepStartSpin = new QDoubleSpinBox(this);
+  sweepStopSpin = new QDoubleSpinBox(this);
+  for (QDoubleSpinBox *spin : {sweepStartSpin, sweepStopSpin}) {
+    spin->setSuffix(" MHz");
+    spin->setDecimals(1);
+    spin->setSingleStep(1.0);
+    spin->setRange(24.0, 1766.0); // R820T tuning range
+  }
+  sweepStartSpin->setValue(400.0);
+  sweepStopSpin->setValue(470.0);
+  sweepButton = new QPushButton("SWEEP", this);
+  sweepButton->setCheckable(true);
 
   exitButton = new QPushButton("EXIT", this);
   exitButton->setObjectName("ExitButton");
@@ -210,6 +228,10 @@ MainWindow::MainWindow(QWidget *parent)
   thresholdSlider->setFocusPolicy(Qt::NoFocus);
   thresholdLabel = new QLabel("Threshold: -40 dB", this);
   triggerStatusLabel = new QLabel("Status: Idle", this);
+  streamHealthLabel = new QLabel(this);
+  streamHealthLabel->hide();
+  deviceStatsLabel = new QLabel(this);
+  deviceStatsLabel->hide();
 
   zoomOutButton = new QPushButton("-", this);
   zoomInButton = new QPushButton("+", this);
@@ -296,6 +318,12 @@ MainWindow::MainWindow(QWidget *parent)
   freqLayout->addSpacing(20);
   freqLayout->addWidget(new QLabel("RX Frequency:", this));
   freqLayout->addWidget(rxFreq);
+  freqLayout->addSpacing(20);
+  freqLayout->addWidget(new QLabel("Sweep:", this));
+  freqLayout->addWidget(sweepStartSpin);
+  freqLayout->addWidget(new QLabel("to", this));
+  freqLayout->addWidget(sweepStopSpin);
+  freqLayout->addWidget(sweepButton);
 
   QFrame *line = new QFrame;
   line->setFrameShape(QFrame::HLine);
@@ -328,6 +356,8 @@ MainWindow::MainWindow(QWidget *parent)
   detectorModeCombo = new QComboBox(this);
   detectorModeCombo->addItem("Averaged"); // index 0
   detectorModeCombo->addItem("Peak");     // index 1
+  // time-domain power in the span, independent of the FFT
+  detectorModeCombo->addItem("Channel power"); // index 2
   detectorModeCombo->setCurrentIndex(0);
   detectorModeCombo->setSizeAdjustPolicy(QComboBox::AdjustToContents);
   detectorModeCombo->setMinimumContentsLength(6);
@@ -354,6 +384,23 @@ MainWindow::MainWindow(QWidget *parent)
   avgTauSpin->setSuffix(" s");
   detLayout->addWidget(avgTauSpin);
 
+  detLayout->addSpacing(12);
+  detLayout->addWidget(new QLabel("Display:", this));
+  displayRateCombo = new QComboBox(this);
+  for (int fps : {60, 30, 15, 5, 1})
+    displayRateCombo->addItem(QString("%1 fps").arg(fps), fps);
+  displayRateCombo->setCurrentIndex(0);
+  displayRateCombo->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+  displayRateCombo->setEditable(false);
+  detLayout->addWidget(displayRateCombo);
+  displayModeCombo = new QComboBox(this);
+  displayModeCombo->addItem("Max hold"); // index 0
+  displayModeCombo->addItem("Average");  // index 1
+  displayModeCombo->setCurrentIndex(0);
+  displayModeCombo->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+  displayModeCombo->setEditable(false);
+  detLayout->addWidget(displayModeCombo);
+
   layout->addLayout(detLayout);
 
   // Trigger status label above trigger controls
@@ -363,6 +410,24 @@ MainWindow::MainWindow(QWidget *parent)
   thLayout->addWidget(new QLabel("Capture Threshold:", this));
   thLayout->addWidget(thresholdSlider, 1);
   thLayout->addWidget(thresholdLabel);
+  // CFAR: follow the noise floor beside the span instead of a fixed level
+  thresholdModeCombo = new QComboBox(this);
+  thresholdModeCombo->addItem("Fixed");   // index 0
+  thresholdModeCombo->addItem("CA-CFAR"); // index 1
+  thresholdModeCombo->addItem("OS-CFAR"); // index 2
+  thresholdModeCombo->setCurrentIndex(0);
+  thresholdModeCombo->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+  thresholdModeCombo->setEditable(false);
+  thLayout->addWidget(thresholdModeCombo);
+  cfarMarginSpin = new QDoubleSpinBox(this);
+  cfarMarginSpin->setDecimals(1);
+  cfarMarginSpin->setRange(0.0, 40.0);
+  cfarMarginSpin->setSingleStep(0.5);
+  cfarMarginSpin->setValue(10.0); // default 10 dB above the floor
+  cfarMarginSpin->setPrefix("+");
+  cfarMarginSpin->setSuffix(" dB");
+  cfarMarginSpin->setEnabled(false);
+  thLayout->addWidget(cfarMarginSpin);
   // Span slider: ±Hz around RX used for detection and visualization
   spanSlider = new QSlider(Qt::Horizontal, this);
   spanSlider->setRange(1, 400); // 1..400 kHz
@@ -375,9 +440,53 @@ MainWindow::MainWindow(QWidget *parent)
   thLayout->addWidget(new QLabel("Capture Span:", this));
   thLayout->addWidget(spanSlider, 1);
   thLayout->addWidget(spanLabel);
+  // Output rate of written captures; 1 Msps matches the replay tool
+  thLayout->addSpacing(16);
+  thLayout->addWidget(new QLabel("Capture Rate:", this));
+  captureRateCombo = new QComboBox(this);
+  captureRateCombo->addItem("Auto", 0.0);
+  captureRateCombo->addItem("250 ksps", 250e3);
+  captureRateCombo->addItem("500 ksps", 500e3);
+  captureRateCombo->addItem("1 Msps", 1e6);
+  captureRateCombo->addItem("2 Msps", 2e6);
+  captureRateCombo->setCurrentIndex(0);
+  captureRateCombo->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+  captureRateCombo->setEditable(false);
+  thLayout->addWidget(captureRateCombo);
   // Place status text above the control row
   layout->addWidget(triggerStatusLabel);
+  layout->addWidget(streamHealthLabel);
+  layout->addWidget(deviceStatsLabel);
   layout->addLayout(thLayout);
+  // Channel plan row: split the RX band into equal channels and trigger
+  // on each watched one by itself
+  QHBoxLayout *chanLayout = new QHBoxLayout;
+  chanLayout->setSpacing(12);
+  chanLayout->addWidget(new QLabel("Channels:", this));
+  channelCountCombo = new QComboBox(this);
+  channelCountCombo->addItem("Off", 0);
+  for (int m : {2, 4, 8, 16})
+    channelCountCombo->addItem(QString::number(m), m);
+  channelCountCombo->setCurrentIndex(0);
+  channelCountCombo->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+  channelCountCombo->setEditable(false);
+  chanLayout->addWidget(channelCountCombo);
+  chanLayout->addWidget(new QLabel("Watch:", this));
+  channelWatchEdit = new QLineEdit(this);
+  channelWatchEdit->setPlaceholderText("channel numbers, e.g. 1, 3");
+  chanLayout->addWidget(channelWatchEdit, 1);
+  chanLayout->addWidget(new QLabel("Channel Threshold:", this));
+  channelThresholdSpin = new QDoubleSpinBox(this);
+  channelThresholdSpin->setDecimals(0);
+  channelThresholdSpin->setRange(-100.0, 0.0);
+  channelThresholdSpin->setSingleStep(1.0);
+  channelThresholdSpin->setValue(-30.0); // ChannelWatch default
+  channelThresholdSpin->setSuffix(" dB");
+  chanLayout->addWidget(channelThresholdSpin);
+  channelStatusLabel = new QLabel(this);
+  channelStatusLabel->hide();
+  layout->addLayout(chanLayout);
+  layout->addWidget(channelStatusLabel);
   // TX noise controls row (under capture controls)
   QHBoxLayout *txNoiseLayout = new QHBoxLayout;
   txNoiseLayout->setSpacing(12);
@@ -428,10 +537,12 @@ MainWindow::MainWindow(QWidget *parent)
                                 sampleRateHz);
   captureBox2->setCaptureSpanHz(spanSlider->value() * 1000.0);
 
+  // direct: the receiver already hands over on the GUI thread and reuses
+  // its frame buffer, so the widgets copy it during the call
   connect(receiver, &SDRReceiver::newFFTData, waterfall,
-          &WaterfallWidget::pushData, Qt::QueuedConnection);
+          &WaterfallWidget::pushData, Qt::DirectConnection);
   connect(receiver, &SDRReceiver::newFFTData, spectrum,
-          &SpectrumWidget::pushData, Qt::QueuedConnection);
+          &SpectrumWidget::pushData, Qt::DirectConnection);
   connect(resetPeaksBtn, &QPushButton::clicked, spectrum,
           &SpectrumWidget::resetPeaks);
   connect(resetCapturesButton, &QPushButton::clicked, this,
@@ -468,6 +579,10 @@ MainWindow::MainWindow(QWidget *parent)
   connect(gainSlider, &QSlider::valueChanged, this, &MainWindow::onGainChanged);
   connect(thresholdSlider, &QSlider::valueChanged, this,
           &MainWindow::onThresholdChanged);
+  connect(thresholdModeCombo, qOverload<int>(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onThresholdModeChanged);
+  connect(cfarMarginSpin, qOverload<double>(&QDoubleSpinBox::valueChanged),
+          this, &MainWindow::onCfarMarginChanged);
   connect(sampleRateCombo, qOverload<int>(&QComboBox::currentIndexChanged),
           this, &MainWindow::onSampleRateChanged);
   connect(spanSlider, &QSlider::valueChanged, this, &MainWindow::onSpanChanged);
@@ -481,6 +596,19 @@ MainWindow::MainWindow(QWidget *parent)
           &MainWindow::onDwellChanged);
   connect(avgTauSpin, qOverload<double>(&QDoubleSpinBox::valueChanged), this,
           &MainWindow::onAvgTauChanged);
+  connect(displayRateCombo, qOverload<int>(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onDisplayRateChanged);
+  connect(displayModeCombo, qOverload<int>(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onDisplayModeChanged);
+  connect(captureRateCombo, qOverload<int>(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onCaptureRateChanged);
+  connect(channelCountCombo, qOverload<int>(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onChannelPlanChanged);
+  connect(channelWatchEdit, &QLineEdit::editingFinished, this,
+          &MainWindow::onChannelPlanChanged);
+  connect(channelThresholdSpin,
+          qOverload<double>(&QDoubleSpinBox::valueChanged), this,
+          &MainWindow::onChannelPlanChanged);
 
   // initialize threshold in receiver
   if (receiver)
@@ -496,8 +624,12 @@ MainWindow::MainWindow(QWidget *parent)
   if (receiver)
     receiver->setDetectorMode(detectorModeCombo->currentIndex());
   if (receiver) {
+    receiver->setThresholdMode(thresholdModeCombo->currentIndex());
+    receiver->setCfarMarginDb(cfarMarginSpin->value());
     receiver->setDwellSeconds(0.02);
     receiver->setAvgTauSeconds(0.20);
+    receiver->setDisplayRate(displayRateCombo->currentData().toDouble());
+    receiver->setDisplayMode(displayModeCombo->currentIndex());
   }
   // Initialize transmitter (HackRF TX)
   transmitter = new SDRTransmitter(this);
@@ -510,20 +642,82 @@ MainWindow::MainWindow(QWidget *parent)
   spectrum->setNoiseSpanHz(noiseSpanSlider->value() * 1000.0);
   qInfo() << "[UI] Initialized with RX(MHz)=" << rxFreq->value()
           << "TX(MHz)=" << txFreq->value() << "SR(Hz)=" << sampleRateHz;
+  connect(receiver, &SDRReceiver::captureProgress, this,
+          &MainWindow::onCaptureProgress);
   connect(receiver, &SDRReceiver::captureCompleted, this,
           &MainWindow::onCaptureCompleted);
   connect(receiver, &SDRReceiver::triggerStatus, this,
           &MainWindow::onTriggerStatus);
+  connect(receiver, &SDRReceiver::noiseFloorChanged, this,
+          &MainWindow::onNoiseFloorChanged);
+  connect(receiver, &SDRReceiver::streamDegraded, this,
+          &MainWindow::onStreamDegraded);
+  connect(receiver, &SDRReceiver::streamRecovering, this,
+          &MainWindow::onStreamRecovering);
+  connect(receiver, &SDRReceiver::streamRecovered, this,
+          &MainWindow::onStreamRecovered);
+  connect(receiver, &SDRReceiver::retuneCompleted, this,
+          &MainWindow::onRetuneCompleted);
+  connect(receiver, &SDRReceiver::streamStats, this,
+          &MainWindow::onStreamStats);
+  connect(receiver, &SDRReceiver::sweepRow, this, &MainWindow::onSweepRow);
+  connect(receiver, &SDRReceiver::channelCaptureCompleted, this,
+          &MainWindow::onChannelCaptureCompleted);
+  connect(sweepButton, &QPushButton::toggled, this,
+          &MainWindow::onSweepToggled);
 
-  // Clear any old captures at program start
-  {
-    QDir capDir("captures");
-    if (capDir.exists()) {
+  // Clear any old captures at program start, along with folders a
+  // previous run moved aside but did not get to delete
+  removeLeftoverCaptures();
+  clearCapturesFolder();
+}
+
+void MainWindow::clearCapturesFolder() {
+  // move the old folder out of the way (one rename) and delete it on the
+  // pool, so a large folder never holds up start-up or the GUI
+  QDir capDir("captures");
+  if (capDir.exists()) {
+    const QString trash =
+        QString("captures.old_%1")
+            .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz"));
+    if (QDir().rename("captures", trash)) {
+      QThreadPool::globalInstance()->start([trash]() {
+        QDir(trash).removeRecursively();
+        qInfo() << "[UI] Cleared previous captures folder";
+      });
+    } else {
       capDir.removeRecursively();
     }
-    QDir().mkpath("captures");
-    qInfo() << "[UI] Cleared previous captures folder";
   }
+  QDir().mkpath("captures");
+}
+
+void MainWindow::removeLeftoverCaptures() {
+  // only called at start-up, before clearCapturesFolder() moves the current
+  // folder aside, so no deletion queued by this run is still pending
+  const QStringList leftovers =
+      QDir().entryList({"captures.old_*"}, QDir::Dirs);
+  if (leftovers.isEmpty())
+    return;
+  QThreadPool::globalInstance()->start([leftovers]() {
+    for (const QString &dir : leftovers)
+      QDir(dir).removeRecursively();
+    qInfo() << "[UI] Removed" << leftovers.size()
+            << "leftover captures folder(s)";
+  });
+}
+
+void MainWindow::setDevices(const QVector<SDRDeviceInfo> &devices) {
+  QVector<SDRDeviceInfo> rx;
+  for (const SDRDeviceInfo &d : devices) {
+    if (d.driver != "rtlsdr")
+      continue;
+    rx.push_back(d);
+    qInfo() << "[UI] RX device" << d.label << "rates=" << d.sampleRates.size()
+            << "gains=" << d.gainNames.join(",");
+  }
+  if (receiver && !rx.isEmpty())
+    receiver->setDevices(rx);
 }
 
 void MainWindow::startWaterfall() {
@@ -575,6 +769,7 @@ void MainWindow::onStart() {
     startButton->setText("START");
     if (receiver)
       receiver->cancelTriggeredCapture();
+    captureSavePercent = -1;
     if (transmitter)
       transmitter->stop();
     captureStatus1->setText("Capture 1: EMPTY");
@@ -602,6 +797,114 @@ void MainWindow::onThresholdChanged(int sliderValue) {
   qInfo() << "[UI] Threshold set to (dB)=" << db;
 }
 
+void MainWindow::onThresholdModeChanged(int index) {
+  const bool cfar = index != 0;
+  thresholdSlider->setEnabled(!cfar);
+  cfarMarginSpin->setEnabled(cfar);
+  if (receiver)
+    receiver->setThresholdMode(index);
+  if (!cfar) {
+    // back to the slider's level; the floor is no longer estimated
+    spectrum->setNoiseFloorDb(std::numeric_limits<double>::quiet_NaN());
+    onThresholdChanged(thresholdSlider->value());
+  }
+  qInfo() << "[UI] Threshold mode ->" << thresholdModeCombo->currentText();
+}
+
+void MainWindow::onCfarMarginChanged(double db) {
+  if (receiver)
+    receiver->setCfarMarginDb(db);
+  qInfo() << "[UI] CFAR margin (dB) ->" << db;
+}
+
+void MainWindow::onNoiseFloorChanged(double floorDb, double thresholdDb) {
+  // a late update from before switching back to Fixed
+  if (thresholdModeCombo->currentIndex() == 0)
+    return;
+  spectrum->setNoiseFloorDb(floorDb);
+  spectrum->setThresholdDb(thresholdDb);
+  thresholdLabel->setText(
+      QString("Threshold: %1 dB").arg(thresholdDb, 0, 'f', 0));
+}
+
+void MainWindow::onStreamDegraded(const QString &reason) {
+  streamHealthLabel->setText(QString("RX stream down (%1), reconnecting...")
+                                 .arg(reason));
+  streamHealthLabel->setStyleSheet("color: #ffb060;");
+  streamHealthLabel->show();
+}
+
+void MainWindow::onStreamRecovering(int attempt) {
+  streamHealthLabel->setText(
+      QString("RX stream down, reconnect attempt %1...").arg(attempt));
+}
+
+void MainWindow::onStreamRecovered(int outageMs) {
+  streamHealthLabel->setText(
+      QString("RX stream recovered after %1 ms").arg(outageMs));
+  streamHealthLabel->setStyleSheet("color: #80ff80;");
+  // unless it went down again in the meantime
+  QTimer::singleShot(3000, this, [this]() {
+    if (streamHealthLabel->text().startsWith("RX stream recovered"))
+      streamHealthLabel->hide();
+  });
+}
+
+void MainWindow::onStreamStats(const StreamStats &stats) {
+  const QString name = stats.serial.isEmpty()
+                           ? QString("SDR %1").arg(stats.device + 1)
+                           : stats.serial;
+  deviceStats[stats.device] =
+      QString("%1: %2 of %3 Msps, ovf %4, ring %5%")
+          .arg(name)
+          .arg(stats.samplesPerSecond / 1e6, 0, 'f', 2)
+          .arg(stats.sampleRate / 1e6, 0, 'f', 2)
+          .arg(stats.overflows)
+          .arg(stats.ringFill * 100.0, 0, 'f', 0);
+  if (deviceStats.size() < 2)
+    return;
+  deviceStatsLabel->setText(QStringList(deviceStats.values()).join("   |   "));
+  deviceStatsLabel->show();
+}
+
+void MainWindow::onRetuneCompleted(double freqMHz, double latencyMs) {
+  rxFreq->setToolTip(QString("Last retune: %1 MHz, settled in %2 ms")
+                         .arg(freqMHz, 0, 'f', 3)
+                         .arg(latencyMs, 0, 'f', 1));
+}
+
+void MainWindow::onSweepToggled(bool on) {
+  const double startMHz = sweepStartSpin->value();
+  const double stopMHz = sweepStopSpin->value();
+  if (on && stopMHz <= startMHz) {
+    sweepButton->setChecked(false);
+    return;
+  }
+  sweepStartSpin->setEnabled(!on);
+  sweepStopSpin->setEnabled(!on);
+  if (on) {
+    receiver->startSweep(startMHz, stopMHz);
+    qInfo() << "[UI] Sweep" << startMHz << "-" << stopMHz << "MHz";
+    return;
+  }
+  receiver->stopSweep();
+  // back to the RX passband
+  waterfall->reset();
+  waterfall->setFrequencyInfo(rxFreq->value() * 1e6, sampleRateHz);
+  spectrum->setFrequencyInfo(rxFreq->value() * 1e6, sampleRateHz);
+  spectrum->resetPeaks();
+  qInfo() << "[UI] Sweep stopped";
+}
+
+void MainWindow::onSweepRow(const QVector<float> &row, double startHz,
+                            double stopHz) {
+  // a row still in flight when the sweep was stopped
+  if (!sweepButton->isChecked())
+    return;
+  waterfall->pushSweepRow(row, startHz, stopHz);
+  spectrum->pushSweepRow(row, startHz, stopHz);
+}
+
 void MainWindow::onSpanChanged(int sliderValue) {
   // slider in kHz units
   int kHz = std::clamp(sliderValue, 1, 400);
@@ -640,20 +943,28 @@ void MainWindow::onNoiseSpanChanged(int kHz) {
   qInfo() << "[UI] Noise span -> ±" << ck << "kHz";
 }
 
-void MainWindow::onCaptureCompleted(const QString &filePath) {
-  Q_UNUSED(filePath);
-  qInfo() << "[UI] Capture completed ->" << filePath;
+void MainWindow::onCaptureProgress(int percent) {
+  captureSavePercent = percent;
+  triggerStatusLabel->setText(
+      QString("Status: Saving capture… %1%").arg(percent));
+  triggerStatusLabel->setStyleSheet("");
+}
+
+void MainWindow::onCaptureCompleted(const CaptureResult &result) {
+  const QString &filePath = result.filePath;
+  qInfo() << "[UI] Capture completed ->" << filePath
+          << "rate=" << result.sampleRate << "trigger="
+          << QDateTime::fromMSecsSinceEpoch(result.triggerTimeNs / 1000000)
+                 .toString(Qt::ISODateWithMs)
+          << "length(s)=" << double(result.samples) / result.sampleRate;
+  captureSavePercent = -1;
 
   if (!capture1Done) {
     // First capture finished, update status and immediately arm for capture 2
     capture1Done = true;
     captureStatus1->setText("Capture 1: CAPTURED");
-    // Compute output sample rate based on current span and decimation logic
-    double spanHalfHz = spanSlider->value() * 1000.0;
-    int D = std::max(1, int(std::floor(sampleRateHz / (2.0 * spanHalfHz))));
-    double outRate = sampleRateHz / double(D);
-    captureBox1->setFrequencyInfo(rxFreq->value() * 1e6, rxFreq->value() * 1e6,
-                                  outRate);
+    captureBox1->setFrequencyInfo(result.centerHz, result.centerHz,
+                                  result.sampleRate);
     captureBox1->loadFromFile(filePath);
     captureBox1->setCompleted(true);
     unlockButton->setEnabled(false);
@@ -675,11 +986,8 @@ void MainWindow::onCaptureCompleted(const QString &filePath) {
     // Second capture finished
     capture2Done = true;
     captureStatus2->setText("Capture 2: CAPTURED");
-    double spanHalfHz = spanSlider->value() * 1000.0;
-    int D = std::max(1, int(std::floor(sampleRateHz / (2.0 * spanHalfHz))));
-    double outRate = sampleRateHz / double(D);
-    captureBox2->setFrequencyInfo(rxFreq->value() * 1e6, rxFreq->value() * 1e6,
-                                  outRate);
+    captureBox2->setFrequencyInfo(result.centerHz, result.centerHz,
+                                  result.sampleRate);
     captureBox2->loadFromFile(filePath);
     captureBox2->setCompleted(true);
     running = false;
@@ -694,18 +1002,81 @@ void MainWindow::onCaptureCompleted(const QString &filePath) {
   }
 }
 
+void MainWindow::onChannelPlanChanged() {
+  ChannelPlan plan;
+  plan.channels = channelCountCombo->currentData().toInt();
+  // watched channels: numbers separated by commas or spaces; anything
+  // else, or a channel the plan does not have, is left out
+  QVector<int> watched;
+  const QStringList fields = channelWatchEdit->text().split(
+      QRegularExpression("[,\\s]+"), Qt::SkipEmptyParts);
+  for (const QString &field : fields) {
+    bool ok = false;
+    const int k = field.toInt(&ok);
+    if (!ok || k < 0 || k >= plan.channels || watched.contains(k))
+      continue;
+    watched.append(k);
+    ChannelWatch w;
+    w.channel = k;
+    w.thresholdDb = channelThresholdSpin->value();
+    plan.watches.append(w);
+  }
+  if (receiver)
+    receiver->setChannelPlan(plan);
+  channelCaptures = 0;
+  if (plan.channels < 2 || plan.watches.isEmpty()) {
+    channelStatusLabel->hide();
+    qInfo() << "[UI] Channel plan off";
+    return;
+  }
+  QStringList names;
+  for (int k : watched)
+    names << QString::number(k);
+  channelStatusLabel->setText(
+      QString("Channels: %1 x %2 kHz, watching %3")
+          .arg(plan.channels)
+          .arg(sampleRateHz / plan.channels / 1000.0, 0, 'f', 1)
+          .arg(names.join(", ")));
+  channelStatusLabel->setStyleSheet("");
+  channelStatusLabel->show();
+  qInfo() << "[UI] Channel plan ->" << plan.channels << "channels, watching"
+          << watched << "threshold(dB)=" << channelThresholdSpin->value();
+}
+
+void MainWindow::onChannelCaptureCompleted(int channel,
+                                           const CaptureResult &result) {
+  ++channelCaptures;
+  qInfo() << "[UI] Channel" << channel << "capture completed ->"
+          << result.filePath << "center(Hz)=" << result.centerHz
+          << "rate=" << result.sampleRate << "length(s)="
+          << double(result.samples) / result.sampleRate;
+  channelStatusLabel->setText(
+      QString("Channel %1 captured at %2 MHz -> %3 (%4 so far)")
+          .arg(channel)
+          .arg(result.centerHz / 1e6, 0, 'f', 3)
+          .arg(QFileInfo(result.filePath).fileName())
+          .arg(channelCaptures));
+  channelStatusLabel->setStyleSheet("color: #80ff80;");
+  channelStatusLabel->show();
+}
+
 void MainWindow::onTriggerStatus(bool armed, bool capturing, double centerDb,
                                  double thresholdDb, bool above) {
   Q_UNUSED(capturing);
   if (!armed) {
+    // keep the save progress visible until the capture lands
+    if (captureSavePercent >= 0)
+      return;
     triggerStatusLabel->setText("Status: Idle");
     triggerStatusLabel->setStyleSheet("");
     return;
   }
   QString state = above ? "Above" : "Below";
-  QString mode = (detectorModeCombo && detectorModeCombo->currentIndex() == 1)
-                     ? "Peak"
-                     : "Avg";
+  static const char *const kModeNames[] = {"Avg", "Peak", "Chan"};
+  const int modeIndex =
+      detectorModeCombo ? std::clamp(detectorModeCombo->currentIndex(), 0, 2)
+                        : 0;
+  QString mode = kModeNames[modeIndex];
   triggerStatusLabel->setText(
       QString("Status: Armed • %1 • %2 (Center: %3 dB | Thr: %4 dB)")
           .arg(state)
@@ -725,8 +1096,27 @@ void MainWindow::onDetectorModeChanged(int index) {
   Q_UNUSED(index);
   if (receiver)
     receiver->setDetectorMode(detectorModeCombo->currentIndex());
-  qInfo() << "[UI] Detector mode ->"
-          << (detectorModeCombo->currentIndex() == 1 ? "Peak" : "Averaged");
+  qInfo() << "[UI] Detector mode ->" << detectorModeCombo->currentText();
+}
+
+void MainWindow::onDisplayRateChanged(int index) {
+  const double fps = displayRateCombo->itemData(index).toDouble();
+  if (receiver)
+    receiver->setDisplayRate(fps);
+  qInfo() << "[UI] Display rate (fps) ->" << fps;
+}
+
+void MainWindow::onDisplayModeChanged(int index) {
+  if (receiver)
+    receiver->setDisplayMode(index);
+  qInfo() << "[UI] Display mode ->" << (index == 1 ? "Average" : "Max hold");
+}
+
+void MainWindow::onCaptureRateChanged(int index) {
+  const double hz = captureRateCombo->itemData(index).toDouble();
+  if (receiver)
+    receiver->setCaptureOutputRate(hz);
+  qInfo() << "[UI] Capture rate (Hz) ->" << hz;
 }
 
 void MainWindow::onDwellChanged(double seconds) {
@@ -753,16 +1143,12 @@ void MainWindow::onResetCaptures() {
   if (receiver) {
     receiver->cancelTriggeredCapture();
   }
+  captureSavePercent = -1;
   running = false;
   startButton->setText("START");
 
   // 3) Clear captures folder on disk
-  {
-    QDir capDir("captures");
-    if (capDir.exists())
-      capDir.removeRecursively();
-    QDir().mkpath("captures");
-  }
+  clearCapturesFolder();
 
   // 4) Reset UI state
   capture1Done = false;
@@ -779,7 +1165,7 @@ void MainWindow::onResetCaptures() {
 }
 
 void MainWindow::onRxFrequencyChanged(double frequencyMHz) {
-  waterfall->setFrequencyInfo(frequencyMHz * 1e6, sampleRateHz);
+  waterfall->retune(frequencyMHz * 1e6);
   waterfall->setRxTxFrequencies(frequencyMHz * 1e6, txFreq->value() * 1e6);
   spectrum->setFrequencyInfo(frequencyMHz * 1e6, sampleRateHz);
   spectrum->setRxTxFrequencies(frequencyMHz * 1e6, txFreq->value() * 1e6);
@@ -790,7 +1176,8 @@ void MainWindow::onRxFrequencyChanged(double frequencyMHz) {
   if (!waterfallActive)
     return;
 
-  waterfall->reset();
+  // the waterfall keeps scrolling across a hop, its rows shifted to the
+  // new centre; peaks belong to the old frequency
   spectrum->resetPeaks();
   receiver->startStream(frequencyMHz, sampleRateHz);
   qInfo() << "[UI] RX frequency changed ->" << frequencyMHz << "MHz";
@@ -885,6 +1272,9 @@ void MainWindow::onSampleRateChanged(int index) {
   if (transmitter) {
     transmitter->setSampleRate(sampleRateHz);
   }
+  // the channels are a fixed fraction of the rate; refresh their width
+  if (channelStatusLabel->isVisible())
+    onChannelPlanChanged();
   qInfo() << "[UI] Sample rate changed ->" << sr;
 }
 
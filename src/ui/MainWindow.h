@@ -8,7 +8,9 @@
 #include <QDoubleSpinBox>
 #include <QEvent>
 #include <QLabel>
+#include <QLineEdit>
 #include <QMainWindow>
+#include <QMap>
 #include <QPushButton>
 #include <QSlider>
 #include <QComboBox>
@@ -19,6 +21,8 @@ class MainWindow : public QMainWindow {
   Q_OBJECT
 public:
   void startWaterfall();
+  // hands the receiver every RTL-SDR found, with its cached capabilities
+  void setDevices(const QVector<SDRDeviceInfo> &devices);
   explicit MainWindow(QWidget *parent = nullptr);
 
 protected:
@@ -35,18 +39,36 @@ private slots:
   void onGainChanged(int sliderValue);
   void onSampleRateChanged(int index);
   void onThresholdChanged(int sliderValue);
+  void onThresholdModeChanged(int index);
+  void onCfarMarginChanged(double db);
+  void onNoiseFloorChanged(double floorDb, double thresholdDb);
+  void onStreamDegraded(const QString &reason);
+  void onStreamRecovering(int attempt);
+  void onStreamRecovered(int outageMs);
+  void onRetuneCompleted(double freqMHz, double latencyMs);
+  void onStreamStats(const StreamStats &stats);
+  void onSweepToggled(bool on);
+  void onSweepRow(const QVector<float> &row, double startHz, double stopHz);
   void onSpanChanged(int sliderValue);
-  void onCaptureCompleted(const QString &filePath);
+  void onCaptureProgress(int percent);
+  void onCaptureCompleted(const CaptureResult &result);
+  void onCaptureRateChanged(int index);
   void onTriggerStatus(bool armed, bool capturing, double centerDb, double thresholdDb, bool above);
   void onDetectorModeChanged(int index);
   void onDwellChanged(double seconds);
   void onAvgTauChanged(double seconds);
+  void onDisplayRateChanged(int index);
+  void onDisplayModeChanged(int index);
   void onResetCaptures();
   void onNoiseIntensityChanged(int value);
   void onNoiseSpanChanged(int kHz);
+  void onChannelPlanChanged();
+  void onChannelCaptureCompleted(int channel, const CaptureResult &result);
 
 private:
   bool eventFilter(QObject *watched, QEvent *event) override;
+  void clearCapturesFolder();
+  void removeLeftoverCaptures();
   int clampZoomStep(int step) const;
   void applyZoomStep(int step);
   static constexpr int kZoomMinStep = 0; // 1x
@@ -55,6 +77,9 @@ private:
   WaterfallWidget *waterfall;
   QDoubleSpinBox *rxFreq;
   QDoubleSpinBox *txFreq;
+  QDoubleSpinBox *sweepStartSpin;
+  QDoubleSpinBox *sweepStopSpin;
+  QPushButton *sweepButton;
   QPushButton *startButton;
   QPushButton *unlockButton;
   QPushButton *exitButton;
@@ -76,10 +101,23 @@ private:
   CapturePreviewWidget *captureBox2{nullptr};
   QSlider *thresholdSlider;
   QLabel *thresholdLabel;
+  QComboBox *thresholdModeCombo;
+  QDoubleSpinBox *cfarMarginSpin;
   QLabel *triggerStatusLabel;
+  QLabel *streamHealthLabel; // only shown while the RX stream is down
+  QLabel *deviceStatsLabel;  // only shown with more than one SDR
+  QMap<int, QString> deviceStats; // latest line per receiver pipeline
   QComboBox *detectorModeCombo;
   QDoubleSpinBox *dwellSpin;
   QDoubleSpinBox *avgTauSpin;
+  QComboBox *displayRateCombo;
+  QComboBox *displayModeCombo;
+  QComboBox *captureRateCombo;
+  // channel plan: split the RX band and trigger on chosen channels
+  QComboBox *channelCountCombo;
+  QLineEdit *channelWatchEdit;
+  QDoubleSpinBox *channelThresholdSpin;
+  QLabel *channelStatusLabel; // only shown while a plan is active
   InfoDialog *infoDialog{nullptr};
 
   // TX controls
@@ -97,4 +135,6 @@ private:
   // Track sequential capture states
   bool capture1Done{false};
   bool capture2Done{false};
+  int captureSavePercent{-1}; // >= 0 while a capture is being written
+  int channelCaptures{0};     // written by the current channel plan
 };
@@ -1,4 +1,5 @@
 #include "SpectrumWidget.h"
+#include "DspKernels.h"
 #include <QPainter>
 #include <QFontMetrics>
 #include <algorithm>
@@ -27,12 +28,22 @@ void SpectrumWidget::pushData(const QVector<float> &linearMagnitudes) {
   if (linearMagnitudes.isEmpty())
     return;
   ensureSize(linearMagnitudes.size());
-  latest = linearMagnitudes;
-  for (int i = 0; i < latest.size(); ++i)
-    peak[i] = std::max(peak[i], latest[i]);
+  // copy into our own buffer rather than sharing the sender's
+  std::copy(linearMagnitudes.begin(), linearMagnitudes.end(), latest.begin());
+  dsp::maxHold(peak.data(), latest.constData(), latest.size());
   update();
 }
 
+void SpectrumWidget::pushSweepRow(const QVector<float> &row, double startHz,
+                                  double stopHz) {
+  const double cHz = 0.5 * (startHz + stopHz);
+  if (cHz != centerHz || stopHz - startHz != sampleRate) {
+    setFrequencyInfo(cHz, stopHz - startHz);
+    resetPeaks();
+  }
+  pushData(row);
+}
+
 void SpectrumWidget::setFrequencyInfo(double cHz, double srHz) {
   centerHz = cHz;
   sampleRate = srHz;
@@ -67,6 +78,11 @@ void SpectrumWidget::setThresholdDb(double db) {
   update();
 }
 
+void SpectrumWidget::setNoiseFloorDb(double db) {
+  noiseFloorDb = db;
+  update();
+}
+
 void SpectrumWidget::setRxTxFrequencies(double rxHz, double txHz) {
   rxFrequencyHz = rxHz;
   txFrequencyHz = txHz;
@@ -111,11 +127,12 @@ void SpectrumWidget::paintEvent(QPaintEvent *) {
     const int n = data.size();
     int srcN = std::max(2, int(std::round(double(n) / zoomFactor())));
     int start = (n - srcN) / 2;
+    // convert only the visible bins, in one vectorised pass
+    traceDb.resize(srcN);
+    dsp::amplitudeToDb(data.constData() + start, 1e-9f, traceDb.data(), srcN);
     for (int k = 1; k < srcN; ++k) {
-      int i0 = start + (k - 1);
-      int i1 = start + k;
-      double d0 = toDb(data[i0]);
-      double d1 = toDb(data[i1]);
+      double d0 = std::clamp(traceDb[k - 1], dBmin, dBmax);
+      double d1 = std::clamp(traceDb[k], dBmin, dBmax);
       double t0 = (d0 - dBmin) / (dBmax - dBmin);
       double t1 = (d1 - dBmin) / (dBmax - dBmin);
       int x0 = r.left() + (k - 1) * r.width() / (srcN - 1);
@@ -143,6 +160,20 @@ void SpectrumWidget::paintEvent(QPaintEvent *) {
                QString("Thr: %1 dB").arg(thresholdDb, 0, 'f', 0));
   }
 
+  // Draw the estimated noise floor under it
+  if (!std::isnan(noiseFloorDb)) {
+    double t = (noiseFloorDb - dBmin) / (dBmax - dBmin);
+    int y = r.bottom() - int(std::round(t * r.height()));
+    QPen floorPen(QColor(180, 120, 255, 200));
+    floorPen.setStyle(Qt::DotLine);
+    floorPen.setWidth(1);
+    p.setPen(floorPen);
+    p.drawLine(r.left(), y, r.right(), y);
+    p.setPen(QColor(180, 120, 255));
+    p.drawText(r.right() - 280, y - 2, 136, 14, Qt::AlignRight,
+               QString("Floor: %1 dB").arg(noiseFloorDb, 0, 'f', 1));
+  }
+
   // Draw capture span overlay on spectrum as in waterfall
   if (sampleRate > 0.0 && rxFrequencyHz > 0.0 && captureSpanHalfHz > 0.0) {
     double span = sampleRate / zoomFactor();
@@ -237,9 +268,7 @@ void SpectrumWidget::paintEvent(QPaintEvent *) {
   }
 
   // Peak dB readout
-  double maxDb = dBmin;
-  for (float v : latest)
-    maxDb = std::max(maxDb, toDb(v));
+  double maxDb = toDb(dsp::maxValue(latest.constData(), latest.size()));
   p.setPen(QColor(255, 255, 0));
   p.drawText(r.right() - 120, r.top() + 2, 118, 16, Qt::AlignRight,
              QString("Peak: %1 dB").arg(maxDb, 0, 'f', 1));
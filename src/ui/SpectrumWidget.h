@@ -9,10 +9,15 @@ public:
 
 public slots:
   void pushData(const QVector<float> &linearMagnitudes);
+  // a stitched sweep row spanning startHz..stopHz; the axis follows it
+  void pushSweepRow(const QVector<float> &row, double startHz,
+                    double stopHz);
   void setFrequencyInfo(double centerHz, double sampleRateHz);
   void resetPeaks();
   void setZoomStep(int step);
   void setThresholdDb(double db);
+  // estimated noise floor (CFAR), NaN hides it
+  void setNoiseFloorDb(double db);
   void setRxTxFrequencies(double rxHz, double txHz);
   void setCaptureSpanHz(double halfSpanHz);
   void setNoiseSpanHz(double halfSpanHz);
@@ -26,6 +31,7 @@ private:
 
   QVector<float> latest; // linear 0..1
   QVector<float> peak;   // peak hold 0..1
+  QVector<float> traceDb; // scratch: visible bins of one trace in dB
   double centerHz{0.0};
   double sampleRate{0.0};
   double rxFrequencyHz{0.0};
@@ -33,6 +39,7 @@ private:
   float dBmin{-110.0f};
   float dBmax{-10.0f};
   double thresholdDb{std::numeric_limits<double>::quiet_NaN()};
+  double noiseFloorDb{std::numeric_limits<double>::quiet_NaN()};
   int zoomStep{0};
   double captureSpanHalfHz{0.0};
   double noiseSpanHalfHz{0.0};
@@ -4,7 +4,8 @@
 #include <QPixmap>
 #include <QVBoxLayout>
 
-SplashScreen::SplashScreen(QWidget *parent) : QWidget(parent) {
+SplashScreen::SplashScreen(SDRManager *manager, QWidget *parent)
+    : QWidget(parent), manager(manager) {
   setStyleSheet(
       "background-color: black; color: cyan; font-family: monospace;");
 
@@ -26,18 +27,17 @@ SplashScreen::SplashScreen(QWidget *parent) : QWidget(parent) {
   layout->addStretch();
   setLayout(layout);
 
-  manager = new SDRManager(this);
-  pollTimer = new QTimer(this);
-  connect(pollTimer, &QTimer::timeout, this, &SplashScreen::checkDevices);
-  pollTimer->start(2000);
+  // discovery runs on its own thread; every enumeration lands here
+  connect(manager, &SDRManager::devicesChanged, this,
+          &SplashScreen::checkDevices);
 }
 
 void SplashScreen::checkDevices() {
-  manager->pollDevices();
-
+  if (ready)
+    return;
   if (manager->hasRTLSDR()) {
     // if (manager->hasRTLSDR() && manager->hasHackRF()) {
-    pollTimer->stop();
+    ready = true;
     emit bothDevicesReady();
   } else {
     QString s = QString("RTL: %1 | HackRF: %2")
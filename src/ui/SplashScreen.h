@@ -1,14 +1,13 @@
-
 #pragma once
 #include "../core/SDRManager.h"
 #include <QLabel>
-#include <QTimer>
 #include <QWidget>
 
 class SplashScreen : public QWidget {
   Q_OBJECT
 public:
-  explicit SplashScreen(QWidget *parent = nullptr);
+  // manager runs discovery; the splash only shows its results
+  explicit SplashScreen(SDRManager *manager, QWidget *parent = nullptr);
 
 signals:
   void bothDevicesReady();
@@ -20,5 +19,5 @@ private:
   QLabel *logo;
   QLabel *status;
   SDRManager *manager;
-  QTimer *pollTimer;
+  bool ready{false};
 };
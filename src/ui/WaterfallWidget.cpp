@@ -1,11 +1,13 @@
 
 #include "WaterfallWidget.h"
+#include "DspKernels.h"
 #include <QFontMetrics>
 #include <QPainter>
 #include <QPen>
 #include <QString>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 static inline void mapHeat(float v, uchar &r, uchar &g, uchar &b) {
   // 0..1: dark teal -> cyan -> yellow -> red
@@ -56,11 +58,12 @@ void WaterfallWidget::pushData(const QVector<float> &data) {
   }
 
   // convert magnitudes to dB and normalize to 0..1
-  QVector<float> norm(data.size());
+  norm.resize(data.size());
   float eps = 1e-9f;
-  for (int i = 0; i < data.size(); ++i) {
-    float db = 20.0f * std::log10(std::max(data[i], eps));
-    float t = (db - dBmin) / (dBmax - dBmin); // map dBmin..dBmax -> 0..1
+  dsp::amplitudeToDb(data.constData(), eps, norm.data(), data.size());
+  const float invRange = 1.0f / (dBmax - dBmin);
+  for (int i = 0; i < norm.size(); ++i) {
+    float t = (norm[i] - dBmin) * invRange; // map dBmin..dBmax -> 0..1
     norm[i] = std::clamp(t, 0.0f, 1.0f);
   }
 
@@ -68,6 +71,18 @@ void WaterfallWidget::pushData(const QVector<float> &data) {
   update();
 }
 
+void WaterfallWidget::pushSweepRow(const QVector<float> &row, double startHz,
+                                  double stopHz) {
+  const double center = 0.5 * (startHz + stopHz);
+  const double span = stopHz - startHz;
+  if (center != centerFrequencyHz || span != sampleRateHz) {
+    // rows of another range would sit under the wrong axis
+    reset();
+    setFrequencyInfo(center, span);
+  }
+  pushData(row);
+}
+
 void WaterfallWidget::setFrequencyInfo(double centerHz, double sampleHz) {
   centerFrequencyHz = centerHz;
   sampleRateHz = sampleHz;
@@ -89,6 +104,18 @@ void WaterfallWidget::setFrequencyInfo(double centerHz, double sampleHz) {
   update();
 }
 
+void WaterfallWidget::retune(double centerHz) {
+  if (!img.isNull() && sampleRateHz > 0.0) {
+    const double binHz = sampleRateHz / double(img.width());
+    const long shift = std::lround((centerHz - centerFrequencyHz) / binHz);
+    if (std::labs(shift) >= img.width())
+      reset(); // nothing of the old passband is left on screen
+    else if (shift != 0)
+      shiftRows(int(shift));
+  }
+  setFrequencyInfo(centerHz, sampleRateHz);
+}
+
 void WaterfallWidget::setRxTxFrequencies(double rxHz, double txHz) {
   rxFrequencyHz = rxHz;
   txFrequencyHz = txHz;
@@ -158,6 +185,25 @@ void WaterfallWidget::appendRow(const QVector<float> &row) {
     filled = true;
 }
 
+void WaterfallWidget::shiftRows(int bins) {
+  // column x takes what was drawn at x + bins; the columns that come into
+  // view have no history and stay black
+  const int w = img.width();
+  const size_t keep = size_t(3 * (w - std::abs(bins)));
+  const size_t blank = size_t(3 * std::abs(bins));
+  for (int y = 0; y < img.height(); ++y) {
+    uchar *scan = img.scanLine(y);
+    if (bins > 0) {
+      std::memmove(scan, scan + blank, keep);
+      std::memset(scan + keep, 0, blank);
+    } else {
+      std::memmove(scan + blank, scan, keep);
+      std::memset(scan, 0, blank);
+    }
+  }
+  update();
+}
+
 void WaterfallWidget::drawFrequencyMarkers(QPainter &painter,
                                            const QRect &targetRect) {
   if (markerFrequencies.isEmpty() || sampleRateHz <= 0.0)
@@ -13,7 +13,13 @@ public:
   explicit WaterfallWidget(QWidget *parent = nullptr);
 public slots:
   void pushData(const QVector<float> &data); // 0..1 or any scale
+  // a stitched sweep row spanning startHz..stopHz; the axis follows it
+  void pushSweepRow(const QVector<float> &row, double startHz,
+                    double stopHz);
   void setFrequencyInfo(double centerFrequencyHz, double sampleRateHz);
+  // new centre at the same rate: the rows already drawn move with their
+  // frequencies, or are cleared if it lies outside their passband
+  void retune(double centerFrequencyHz);
   void setRxTxFrequencies(double rxHz, double txHz);
   void setZoomStep(int step); // 0 -> 1x, 1 -> 2x, 2 -> 4x, ...
   void setCaptureSpanHz(double halfSpanHz);
@@ -25,8 +31,10 @@ protected:
 
 private:
   void appendRow(const QVector<float> &row);
+  void shiftRows(int bins);
   void drawFrequencyMarkers(QPainter &painter, const QRect &targetRect);
   QImage img; // width = fft bins, height = maxRows
+  QVector<float> norm; // scratch: current row normalized to 0..1
   int maxRows;
   int nextRow; // circular write index
   bool filled;
@@ -69,8 +69,8 @@ InfoDialog::InfoDialog(QWidget *parent) : QDialog(parent) {
 
   <h3 style='color:cyan;'>Files & Storage</h3>
   <ul>
-    <li>While Armed, raw complex samples are spooled to a temporary <code>captures/in_progress_*.cf32.part</code> file for visibility.</li>
-    <li>On capture completion, a trimmed <code>.cf32</code> file is written to the <code>captures/</code> folder. Names include RX MHz and threshold.</li>
+    <li>While Armed, raw 8-bit IQ samples are spooled to a temporary <code>captures/in_progress_*.cs8.part</code> file for visibility.</li>
+    <li>On capture completion, a trimmed <code>.cf32</code> file is written to the <code>captures/</code> folder. Names include RX MHz and threshold; a <code>.sigmf-meta</code> sidecar next to it records the sample rate, centre frequency, gain, filter factors, UTC start time, the trigger's position in the file and a seek index.</li>
   </ul>
 
   <h3 style='color:cyan;'>Tips</h3>